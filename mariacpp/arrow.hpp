@@ -0,0 +1,87 @@
+/****************************************************************************
+  Copyright (C) 2015 Karol Roslaniec <mariacpp@roslaniec.net>
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not see <http://www.gnu.org/licenses>
+  or write to the Free Software Foundation, Inc.,
+  51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+*****************************************************************************/
+#ifndef MARIACPP_ARROW_HPP
+#define MARIACPP_ARROW_HPP
+
+#include <mariacpp/columnar_result.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+
+// Apache Arrow C Data Interface (ABI-stable, may be defined by arrow/c/abi.h)
+#ifndef ARROW_C_DATA_INTERFACE
+#define ARROW_C_DATA_INTERFACE
+
+#define ARROW_FLAG_DICTIONARY_ORDERED 1
+#define ARROW_FLAG_NULLABLE 2
+#define ARROW_FLAG_MAP_KEYS_SORTED 4
+
+struct ArrowSchema {
+    const char* format;
+    const char* name;
+    const char* metadata;
+    int64_t flags;
+    int64_t n_children;
+    struct ArrowSchema** children;
+    struct ArrowSchema* dictionary;
+    void (*release)(struct ArrowSchema*);
+    void* private_data;
+};
+
+struct ArrowArray {
+    int64_t length;
+    int64_t null_count;
+    int64_t offset;
+    int64_t n_buffers;
+    int64_t n_children;
+    const void** buffers;
+    struct ArrowArray** children;
+    struct ArrowArray* dictionary;
+    void (*release)(struct ArrowArray*);
+    void* private_data;
+};
+
+#endif /* ARROW_C_DATA_INTERFACE */
+
+namespace MariaCpp {
+
+    class PreparedStatement;
+
+    class ResultSet;
+
+    //  Exports result as Arrow record batch: struct array ("+s") with one
+    //  nullable child per column. Column types map to:
+    //     COLUMN_INT64 -> int64 ("l"), COLUMN_UINT64 -> uint64 ("L"),
+    //     COLUMN_DOUBLE -> float64 ("g"), COLUMN_STRING -> large_utf8 ("U"),
+    //     or large_binary ("Z") for binary charset.
+    //  Column arrays are moved into exported batch (no copy), and are
+    //  freed by release() callbacks. Both schema and array are owned
+    //  by caller, e.g. passed to pyarrow or arrow::ImportRecordBatch().
+    void export_arrow(ColumnarResult&& result, ArrowSchema* schema, ArrowArray* array);
+
+    // Exports next batch of at most max_rows rows, call repeatedly
+    // until batch of 0 rows is returned (array->length == 0).
+    void export_arrow(ResultSet& res, ArrowSchema* schema, ArrowArray* array,
+                      size_t max_rows = std::numeric_limits<size_t>::max());
+
+    void export_arrow(PreparedStatement& stmt, ArrowSchema* schema, ArrowArray* array,
+                      size_t max_rows = std::numeric_limits<size_t>::max());
+}
+
+#endif
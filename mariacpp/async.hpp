@@ -0,0 +1,245 @@
+/****************************************************************************
+  Copyright (C) 2015 Karol Roslaniec <mariacpp@roslaniec.net>
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not see <http://www.gnu.org/licenses>
+  or write to the Free Software Foundation, Inc.,
+  51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+*****************************************************************************/
+#ifndef MARIACPP_ASYNC_HPP
+#define MARIACPP_ASYNC_HPP
+
+#include <mysql.h>
+#include <coroutine>
+#include <exception>
+#include <functional>
+#include <type_traits>
+#include <utility>
+
+#ifdef MARIADB_VERSION_ID
+
+namespace MariaCpp {
+
+    class Connection;
+
+    //  Executes non-blocking operations on behalf of coroutines.
+    //  submit() has to call cont(status) whenever socket of connection
+    //  becomes ready for async_status(), and done() once async_status()
+    //  is 0 or cont() has thrown. Reactor is the default implementation.
+    //  Scheduler is chosen per thread; without one, awaiting an operation
+    //  falls back to blocking async_wait() loop.
+    class AsyncScheduler {
+    public:
+        typedef std::function<void(int status)> Continuation;
+
+        typedef std::function<void(std::exception_ptr error)> Completion;
+
+        virtual ~AsyncScheduler() {}
+
+        virtual void submit(Connection& conn, Continuation cont, Completion done) = 0;
+
+        // Scheduler of calling thread (may be null)
+        static AsyncScheduler* current();
+
+        // Sets scheduler of calling thread, returns previous one
+        static AsyncScheduler* current(AsyncScheduler* scheduler);
+    };
+
+    // Sets scheduler of calling thread for lifetime of this object
+    class scoped_scheduler {
+    public:
+        explicit scoped_scheduler(AsyncScheduler& scheduler)
+                : _prev(AsyncScheduler::current(&scheduler)) {}
+
+        ~scoped_scheduler() { AsyncScheduler::current(_prev); }
+
+    private:
+        // Noncopyable
+        scoped_scheduler(const scoped_scheduler&);
+
+        void operator=(scoped_scheduler&);
+
+        AsyncScheduler* _prev;
+    };
+
+    //  Awaitable non-blocking operation, returned by *_async() methods:
+    //     co_await conn.query_async(sql);
+    //     std::unique_ptr<ResultSet> res(co_await conn.store_result_async());
+    //     while (co_await res->next_async()) { ... }
+    //  Operation is started when awaited.
+    class AsyncOpBase {
+    public:
+        void await_suspend(std::coroutine_handle<> handle);
+
+    protected:
+        explicit AsyncOpBase(Connection& conn);
+
+        ~AsyncOpBase() {}
+
+        // True if operation is finished (blocking if there is no scheduler)
+        bool finished();
+
+        void rethrow() const { if (_error) std::rethrow_exception(_error); }
+
+        virtual void resume(int status) = 0;
+
+    private:
+        // Noncopyable
+        AsyncOpBase(const AsyncOpBase&);
+
+        void operator=(AsyncOpBase&);
+
+        Connection& _conn;
+        AsyncScheduler* _scheduler;
+        std::exception_ptr _error;
+    };
+
+    template<class R>
+    class Awaitable : public AsyncOpBase {
+    public:
+        Awaitable(Connection& conn, std::function<R()> start, std::function<R(int)> cont)
+                : AsyncOpBase(conn), _start(std::move(start)), _cont(std::move(cont)) {}
+
+        bool await_ready() {
+            store(_start);
+            return finished();
+        }
+
+        R await_resume() {
+            rethrow();
+            if constexpr (!std::is_void_v<R>) return std::move(_result);
+        }
+
+    private:
+        void resume(int status) override { store([&] { return _cont(status); }); }
+
+        template<class F>
+        void store(F&& func) {
+            if constexpr (std::is_void_v<R>) func();
+            else _result = func();
+        }
+
+        struct Empty {};
+
+        std::function<R()> _start;
+        std::function<R(int)> _cont;
+        std::conditional_t<std::is_void_v<R>, Empty, R> _result{};
+    };
+
+    template<class T>
+    class Task;
+
+    class TaskPromiseBase {
+    public:
+        std::suspend_always initial_suspend() noexcept { return {}; }
+
+        struct FinalAwaiter {
+            bool await_ready() noexcept { return false; }
+
+            template<class P>
+            std::coroutine_handle<> await_suspend(std::coroutine_handle<P> handle) noexcept {
+                return handle.promise()._continuation;
+            }
+
+            void await_resume() noexcept {}
+        };
+
+        FinalAwaiter final_suspend() noexcept { return {}; }
+
+        void unhandled_exception() { _error = std::current_exception(); }
+
+        std::coroutine_handle<> _continuation = std::noop_coroutine();
+        std::exception_ptr _error;
+    };
+
+    template<class T>
+    class TaskPromise : public TaskPromiseBase {
+    public:
+        Task<T> get_return_object();
+
+        template<class U>
+        void return_value(U&& value) { _value = std::forward<U>(value); }
+
+        T result() {
+            if (_error) std::rethrow_exception(_error);
+            return std::move(_value);
+        }
+
+    private:
+        T _value{};
+    };
+
+    template<>
+    class TaskPromise<void> : public TaskPromiseBase {
+    public:
+        Task<void> get_return_object();
+
+        void return_void() {}
+
+        void result() { if (_error) std::rethrow_exception(_error); }
+    };
+
+    //  Lazily started coroutine returning T. It runs when awaited
+    //  by another coroutine, or when passed to spawn().
+    template<class T = void>
+    class Task {
+    public:
+        typedef TaskPromise<T> promise_type;
+
+        Task(Task&& other) noexcept : _handle(std::exchange(other._handle, nullptr)) {}
+
+        Task& operator=(Task&& other) noexcept {
+            if (this != &other) {
+                if (_handle) _handle.destroy();
+                _handle = std::exchange(other._handle, nullptr);
+            }
+            return *this;
+        }
+
+        ~Task() { if (_handle) _handle.destroy(); }
+
+        bool await_ready() const noexcept { return !_handle || _handle.done(); }
+
+        std::coroutine_handle<> await_suspend(std::coroutine_handle<> caller) noexcept {
+            _handle.promise()._continuation = caller;
+            return _handle;
+        }
+
+        T await_resume() { return _handle.promise().result(); }
+
+    private:
+        explicit Task(std::coroutine_handle<promise_type> handle) : _handle(handle) {}
+
+        friend class TaskPromise<T>;
+
+        std::coroutine_handle<promise_type> _handle;
+    };
+
+    template<class T>
+    Task<T> TaskPromise<T>::get_return_object() {
+        return Task<T>(std::coroutine_handle<TaskPromise>::from_promise(*this));
+    }
+
+    inline Task<void> TaskPromise<void>::get_return_object() {
+        return Task<void>(std::coroutine_handle<TaskPromise>::from_promise(*this));
+    }
+
+    //  Starts task without awaiting it; it runs until its first suspension
+    //  and is then resumed by the scheduler. done() is called with error
+    //  (or null) once task is finished. Uncaught error without done()
+    //  terminates program, like in case of std::thread.
+    void spawn(Task<void> task, AsyncScheduler::Completion done = AsyncScheduler::Completion());
+}
+
+#endif /* MARIADB_VERSION_ID */
+#endif
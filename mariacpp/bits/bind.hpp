@@ -22,6 +22,7 @@
 #include <mysql.h>
 #include <cstdint>
 #include <string>
+#include <string_view>
 
 namespace MariaCpp {
 
@@ -89,10 +90,29 @@ namespace MariaCpp {
 
         bool setTimeStamp(const uint64_t time) { return setUInt64(time); }
 
+        // Column-wise array for bulk execution (STMT_ATTR_ARRAY_SIZE).
+        // Arrays are not copied, they must stay valid until execute().
+        // Strings use array of pointers (values) and array of lengths.
+        // indicators (STMT_INDICATOR_*) may be NULL if there are no NULLs.
+        // Any other set*() method switches back to single value.
+        bool setArray(enum_field_types type, bool is_unsigned, const void* values,
+                      const unsigned long* lengths, const char* indicators);
+
+        bool isArray() const { return _array; }
+
         bool isNull() const { return _null; }
 
         std::string getString() const;
 
+        // Types kept as string in result buffer (DECIMAL, BLOB, ENUM...)
+        static bool isStringType(enum_field_types type);
+
+        // Only for string-like columns, view is valid until next fetch
+        std::string_view getStringView() const;
+
+        // Debug builds overwrite viewed data before next fetch
+        void expire_views();
+
         int32_t getInt() const;
 
         uint32_t getUInt() const;
@@ -143,6 +163,10 @@ namespace MariaCpp {
         my_bool _unsigned;
         my_bool _error;
         Buffer::heap_t _heap;
+        mutable bool _viewed; // getStringView() was called
+        const void* _array;
+        const unsigned long* _lengths;
+        const char* _indicators;
     };
 }
 #endif
@@ -0,0 +1,68 @@
+/****************************************************************************
+  Copyright (C) 2015 Karol Roslaniec <mariacpp@roslaniec.net>
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not see <http://www.gnu.org/licenses>
+  or write to the Free Software Foundation, Inc.,
+  51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+*****************************************************************************/
+#ifndef MARIACPP_BITS_COLUMN_INDEX_HPP
+#define MARIACPP_BITS_COLUMN_INDEX_HPP
+
+#include <mysql.h>
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace MariaCpp {
+
+    // Column resolved by name once, usable as index on every row:
+    //     MariaCpp::ColumnRef label = res->column("label");
+    //     while (res->next()) use(res->getString(label));
+    struct ColumnRef {
+        unsigned int index;
+
+        operator unsigned int() const { return index; }
+    };
+
+    //  Case-insensitive (ASCII) hash index of column names,
+    //  built once from result metadata. The first of duplicate
+    //  names wins, as with linear search.
+    class ColumnIndex {
+    public:
+        ColumnIndex() : _mask() {}
+
+        void assign(const MYSQL_FIELD* fields, unsigned int count);
+
+        void clear();
+
+        bool empty() const { return _names.empty(); }
+
+        // -1 if there is no such column
+        int find(std::string_view name) const;
+
+        const std::string& name(unsigned int col) const { return _names[col]; }
+
+    private:
+        static size_t hash(std::string_view name);
+
+        static bool equals(std::string_view a, std::string_view b);
+
+        std::vector<std::string> _names;
+        std::vector<unsigned int> _slots; // column + 1, 0 if empty
+        size_t _mask;
+    };
+}
+
+#endif
@@ -0,0 +1,56 @@
+/****************************************************************************
+  Copyright (C) 2015 Karol Roslaniec <mariacpp@roslaniec.net>
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not see <http://www.gnu.org/licenses>
+  or write to the Free Software Foundation, Inc.,
+  51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+*****************************************************************************/
+#ifndef MARIACPP_BITS_DECODE_HPP
+#define MARIACPP_BITS_DECODE_HPP
+
+#include <cstddef>
+#include <cstdint>
+
+namespace MariaCpp {
+
+    //  Batch decoding of one column of text protocol rows:
+    //  count cells, every stride-th of cells and lengths (i.e. rows
+    //  of MYSQL_ROW and fetch_lengths() copied one after another,
+    //  stride = number of columns). NULL cell decodes as 0.
+    //  Integers of up to 16 digits are parsed by SSE4.2 or AVX2
+    //  kernel if CPU supports it, other cells by std::from_chars.
+    void decode_int64(const char* const* cells, const unsigned long* lengths,
+                      size_t stride, size_t count, int64_t* out);
+
+    void decode_uint64(const char* const* cells, const unsigned long* lengths,
+                       size_t stride, size_t count, uint64_t* out);
+
+    // Always scalar (std::from_chars)
+    void decode_double(const char* const* cells, const unsigned long* lengths,
+                       size_t stride, size_t count, double* out);
+
+    enum decode_kernel {
+        DECODE_SCALAR,
+        DECODE_SSE42,
+        DECODE_AVX2
+    };
+
+    // Kernel selected by CPU dispatch
+    decode_kernel decode_kernel_in_use();
+
+    // For benchmarks and tests; kernel not supported by CPU is not used
+    void set_decode_kernel(decode_kernel kernel);
+}
+
+#endif
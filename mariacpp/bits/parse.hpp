@@ -0,0 +1,62 @@
+/****************************************************************************
+  Copyright (C) 2015 Karol Roslaniec <mariacpp@roslaniec.net>
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not see <http://www.gnu.org/licenses>
+  or write to the Free Software Foundation, Inc.,
+  51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+*****************************************************************************/
+#ifndef MARIACPP_BITS_PARSE_HPP
+#define MARIACPP_BITS_PARSE_HPP
+
+#include <charconv>
+#include <cstdint>
+#include <cstdlib>
+#include <string>
+#include <type_traits>
+
+namespace MariaCpp {
+
+    //  Locale-free parsing of numbers sent as text (text protocol,
+    //  DECIMAL and string columns), bounded by length of the data.
+    //  Like strtol() it stops at first invalid character ("12.5" -> 12)
+    //  and returns 0 if there is no number at all. Unlike strtol()
+    //  (std::from_chars rules), leading whitespace and '+' are not
+    //  accepted (result 0) and out of range value gives 0, not the
+    //  saturated limit. Server never sends numbers in such form.
+    template<typename T>
+    T from_chars(const char* first, const char* last) {
+        T out = T();
+        if constexpr (std::is_integral<T>::value) {
+            std::from_chars(first, last, out);
+        } else {
+#if __cpp_lib_to_chars >= 201611L
+            std::from_chars(first, last, out);
+#else
+            const std::string str(first, last - first);
+            if constexpr (std::is_same<T, float>::value) out = strtof(str.c_str(), nullptr);
+            else out = strtod(str.c_str(), nullptr);
+#endif
+        }
+        return out;
+    }
+
+    // Integer column of any signedness converted to T (as C cast would)
+    template<typename T>
+    T from_chars(const char* first, const char* last, bool is_unsigned) {
+        if (is_unsigned) return static_cast<T>(from_chars<uint64_t>(first, last));
+        return static_cast<T>(from_chars<int64_t>(first, last));
+    }
+}
+
+#endif
@@ -0,0 +1,151 @@
+/****************************************************************************
+  Copyright (C) 2015 Karol Roslaniec <mariacpp@roslaniec.net>
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not see <http://www.gnu.org/licenses>
+  or write to the Free Software Foundation, Inc.,
+  51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+*****************************************************************************/
+#ifndef MARIACPP_ROW_BINDING_HPP
+#define MARIACPP_ROW_BINDING_HPP
+
+#include <mysql.h>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+namespace MariaCpp {
+
+    // Buffer type of struct member bound row-wise (see field())
+    template<class T>
+    struct bind_type;
+
+    template<>
+    struct bind_type<int8_t> {
+        static constexpr enum_field_types type = MYSQL_TYPE_TINY;
+        static constexpr bool is_unsigned = false;
+    };
+
+    template<>
+    struct bind_type<uint8_t> {
+        static constexpr enum_field_types type = MYSQL_TYPE_TINY;
+        static constexpr bool is_unsigned = true;
+    };
+
+    template<>
+    struct bind_type<int16_t> {
+        static constexpr enum_field_types type = MYSQL_TYPE_SHORT;
+        static constexpr bool is_unsigned = false;
+    };
+
+    template<>
+    struct bind_type<uint16_t> {
+        static constexpr enum_field_types type = MYSQL_TYPE_SHORT;
+        static constexpr bool is_unsigned = true;
+    };
+
+    template<>
+    struct bind_type<int32_t> {
+        static constexpr enum_field_types type = MYSQL_TYPE_LONG;
+        static constexpr bool is_unsigned = false;
+    };
+
+    template<>
+    struct bind_type<uint32_t> {
+        static constexpr enum_field_types type = MYSQL_TYPE_LONG;
+        static constexpr bool is_unsigned = true;
+    };
+
+    template<>
+    struct bind_type<int64_t> {
+        static constexpr enum_field_types type = MYSQL_TYPE_LONGLONG;
+        static constexpr bool is_unsigned = false;
+    };
+
+    template<>
+    struct bind_type<uint64_t> {
+        static constexpr enum_field_types type = MYSQL_TYPE_LONGLONG;
+        static constexpr bool is_unsigned = true;
+    };
+
+    template<>
+    struct bind_type<float> {
+        static constexpr enum_field_types type = MYSQL_TYPE_FLOAT;
+        static constexpr bool is_unsigned = false;
+    };
+
+    template<>
+    struct bind_type<double> {
+        static constexpr enum_field_types type = MYSQL_TYPE_DOUBLE;
+        static constexpr bool is_unsigned = false;
+    };
+
+    // Strings are stored inline in row (connector reads param at
+    // row + row_size * i, so pointer member can't be bound), and need
+    // length member, see field(value, length)
+    template<size_t N>
+    struct bind_type<char[N]> {
+        static constexpr enum_field_types type = MYSQL_TYPE_STRING;
+        static constexpr bool is_unsigned = false;
+    };
+
+    // Use Field::as() for MYSQL_TYPE_DATE or MYSQL_TYPE_TIME
+    template<>
+    struct bind_type<MYSQL_TIME> {
+        static constexpr enum_field_types type = MYSQL_TYPE_DATETIME;
+        static constexpr bool is_unsigned = false;
+    };
+
+    //  Describes one column of struct Row by member pointers:
+    //  value, optional length (strings) and optional indicator
+    //  (STMT_INDICATOR_*) members. When fetching results
+    //  (PreparedStatement::bindResult()), indicator is set to 1 for NULL.
+    template<class Row, class T>
+    struct Field {
+        T Row::* value;
+        unsigned long Row::* length;
+        char Row::* indicator;
+        enum_field_types type;
+
+        constexpr Field as(enum_field_types field_type) const {
+            return Field{value, length, indicator, field_type};
+        }
+    };
+
+    template<class Row, class T>
+    constexpr Field<Row, T> field(T Row::* value, char Row::* indicator = nullptr) {
+        static_assert(!std::is_array_v<T>, "char[N] needs a length member, use field(value, length)");
+        return Field<Row, T>{value, nullptr, indicator, bind_type<T>::type};
+    }
+
+    // String param or result column in char array; length holds length
+    // of param, or full length of fetched value (see truncated())
+    template<class Row, size_t N>
+    constexpr Field<Row, char[N]> field(char (Row::* value)[N], unsigned long Row::* length,
+                                        char Row::* indicator = nullptr) {
+        return Field<Row, char[N]>{value, length, indicator, bind_type<char[N]>::type};
+    }
+
+    //  Default columns of Row, used by executeRows(rows) and bindResult(row)
+    //  without fields.
+    //  Specialize with static fields() returning std::tuple of Field:
+    //     template<> struct row_mapping<Item> {
+    //         static constexpr auto fields() {
+    //             return std::make_tuple(field(&Item::id), field(&Item::name, &Item::name_len));
+    //         }
+    //     };
+    template<class Row>
+    struct row_mapping;
+}
+
+#endif
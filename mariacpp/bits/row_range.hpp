@@ -0,0 +1,191 @@
+/****************************************************************************
+  Copyright (C) 2015 Karol Roslaniec <mariacpp@roslaniec.net>
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not see <http://www.gnu.org/licenses>
+  or write to the Free Software Foundation, Inc.,
+  51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+*****************************************************************************/
+#ifndef MARIACPP_ROW_RANGE_HPP
+#define MARIACPP_ROW_RANGE_HPP
+
+#include <mysql.h>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+namespace MariaCpp {
+
+    class PreparedStatement;
+
+    class ResultSet;
+
+    struct Time;
+
+    // What column of rows<Ts...>() must be convertible to
+    enum column_kind {
+        COLUMN_NUMBER,
+        COLUMN_STRING,
+        COLUMN_STRING_VIEW, // string-like data (binary protocol)
+        COLUMN_TIME
+    };
+
+    // Throw InvalidArgumentException unless result has count columns of given kinds
+    void check_columns(ResultSet& res, const column_kind* kinds, unsigned int count);
+
+    void check_columns(PreparedStatement& stmt, const column_kind* kinds, unsigned int count);
+
+    // Fetches next row of ResultSet (next()) or PreparedStatement (fetch())
+    template<class Result>
+    bool next_row(Result& res) {
+        if constexpr (requires { res.fetch(); }) return res.fetch();
+        else return res.next();
+    }
+
+    //  Input iterator over rows of result (see ResultSet::begin()),
+    //  dereferenced to the result itself, positioned on current row:
+    //     for (const MariaCpp::ResultSet& row: *res) use(row.getInt(0));
+    //     auto ids = *res | std::views::transform([](auto& row) { return row.getInt(0); });
+    template<class Result>
+    class RowCursor {
+    public:
+        typedef std::ptrdiff_t difference_type;
+        typedef Result value_type;
+        typedef std::input_iterator_tag iterator_concept;
+
+        RowCursor() : _res() {}
+
+        // Fetches first row
+        explicit RowCursor(Result* res) : _res(res) { ++*this; }
+
+        const Result& operator*() const { return *_res; }
+
+        const Result* operator->() const { return _res; }
+
+        RowCursor& operator++() {
+            if (!next_row(*_res)) _res = nullptr;
+            return *this;
+        }
+
+        void operator++(int) { ++*this; }
+
+        friend bool operator==(const RowCursor& it, std::default_sentinel_t) { return !it._res; }
+
+    private:
+        Result* _res; // null at the end
+    };
+
+    // Conversion of single column to T, selected at compile time
+    template<class T>
+    struct column_value {
+        static_assert(std::is_arithmetic_v<T> || std::is_same_v<T, std::string>
+                      || std::is_same_v<T, std::string_view> || std::is_same_v<T, Time>,
+                      "unsupported column type");
+
+        static constexpr column_kind kind =
+                std::is_arithmetic_v<T> ? COLUMN_NUMBER :
+                std::is_same_v<T, std::string> ? COLUMN_STRING :
+                std::is_same_v<T, std::string_view> ? COLUMN_STRING_VIEW : COLUMN_TIME;
+
+        template<class Result>
+        static T get(const Result& res, unsigned int col) {
+            if constexpr (std::is_same_v<T, bool>) return res.getInt64(col) != 0;
+            else if constexpr (std::is_floating_point_v<T>) return static_cast<T>(res.getDouble(col));
+            else if constexpr (std::is_integral_v<T> && std::is_signed_v<T>) return static_cast<T>(res.getInt64(col));
+            else if constexpr (std::is_integral_v<T>) return static_cast<T>(res.getUInt64(col));
+            else if constexpr (std::is_same_v<T, std::string>) return res.getString(col);
+            else if constexpr (std::is_same_v<T, std::string_view>) return res.getStringView(col);
+            else return res.getDateTime(col);
+        }
+    };
+
+    // NULL is std::nullopt, otherwise NULL reads as 0 (or empty)
+    template<class T>
+    struct column_value<std::optional<T>> {
+        static constexpr column_kind kind = column_value<T>::kind;
+
+        template<class Result>
+        static std::optional<T> get(const Result& res, unsigned int col) {
+            if (res.isNull(col)) return std::nullopt;
+            return column_value<T>::get(res, col);
+        }
+    };
+
+    //  Input range of rows decoded to std::tuple<Ts...>, see ResultSet::rows().
+    //  Column count and types are checked once, when range is created;
+    //  each row is fetched by iterator increment.
+    template<class Result, class... Ts>
+    class RowRange {
+    public:
+        typedef std::tuple<Ts...> value_type;
+
+        explicit RowRange(Result& res) : _res(res), _more(false) {
+            static constexpr column_kind kinds[] = {column_value<Ts>::kind...};
+            check_columns(res, kinds, sizeof...(Ts));
+        }
+
+        class iterator {
+        public:
+            typedef std::ptrdiff_t difference_type;
+            typedef std::tuple<Ts...> value_type;
+            typedef std::input_iterator_tag iterator_concept;
+
+            iterator() : _range() {}
+
+            explicit iterator(RowRange* range) : _range(range) {}
+
+            value_type operator*() const { return _range->decode(std::index_sequence_for<Ts...>()); }
+
+            iterator& operator++() {
+                _range->fetch();
+                return *this;
+            }
+
+            void operator++(int) { ++*this; }
+
+            friend bool operator==(const iterator& it, std::default_sentinel_t) { return it.at_end(); }
+
+        private:
+            bool at_end() const { return !_range->_more; }
+
+            RowRange* _range;
+        };
+
+        // Fetches first row, so it may be called once only
+        iterator begin() {
+            fetch();
+            return iterator(this);
+        }
+
+        std::default_sentinel_t end() const { return std::default_sentinel; }
+
+    private:
+        void fetch() { _more = next_row(_res); }
+
+        template<size_t... I>
+        value_type decode(std::index_sequence<I...>) const {
+            return value_type(column_value<Ts>::get(_res, I)...);
+        }
+
+        Result& _res;
+        bool _more;
+    };
+}
+
+#endif
@@ -0,0 +1,180 @@
+/****************************************************************************
+  Copyright (C) 2015 Karol Roslaniec <mariacpp@roslaniec.net>
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not see <http://www.gnu.org/licenses>
+  or write to the Free Software Foundation, Inc.,
+  51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+*****************************************************************************/
+#ifndef MARIACPP_TIMER_WHEEL_HPP
+#define MARIACPP_TIMER_WHEEL_HPP
+
+#include <bit>
+#include <cassert>
+#include <cstdint>
+
+namespace MariaCpp {
+
+    //  Hierarchical timer wheel with 1 tick resolution (Reactor uses ms).
+    //  LEVELS levels of 64 slots each cover 64^LEVELS ticks; later
+    //  deadlines are parked in the last level and re-inserted when reached.
+    //  Timers are intrusive (no allocation), schedule() and cancel() are O(1),
+    //  advance() is O(1) per elapsed tick plus O(1) per expired timer.
+    class TimerWheel {
+    public:
+        struct Link {
+            Link* prev = nullptr;
+            Link* next = nullptr;
+        };
+
+        // Embed (or derive from) Timer in object which needs timeout
+        struct Timer : Link {
+            uint64_t expires = 0;
+            unsigned slot = 0;
+
+            bool armed() const { return next != nullptr; }
+        };
+
+        explicit TimerWheel(uint64_t now) : _now(now), _count(0), _occupied() {
+            for (auto& level: _slots)
+                for (auto& head: level) head.prev = head.next = &head;
+        }
+
+        ~TimerWheel() { assert(!_count); }
+
+        uint64_t now() const { return _now; }
+
+        bool empty() const { return !_count; }
+
+        // (Re)arms timer to expire at given tick
+        void schedule(Timer& timer, uint64_t expires) {
+            if (timer.armed()) cancel(timer);
+            timer.expires = expires <= _now ? _now + 1 : expires;
+            place(timer);
+            ++_count;
+        }
+
+        void cancel(Timer& timer) {
+            if (!timer.armed()) return;
+            unlink(timer);
+            --_count;
+        }
+
+        // Ticks until the first slot which needs processing (-1 if empty).
+        // It's lower bound only: timer may be still cascaded down then.
+        int64_t next_timeout() const {
+            if (!_count) return -1;
+            for (unsigned level = 0; level < LEVELS; ++level) {
+                const unsigned shift = BITS * level;
+                const unsigned index = (_now >> shift) & MASK;
+                // Slots behind current index belong to next round
+                const uint64_t ahead = _occupied[level] & (~uint64_t(0) << index);
+                if (!ahead) continue;
+                const unsigned slot = std::countr_zero(ahead);
+                const uint64_t round = _now >> (shift + BITS) << (shift + BITS);
+                const uint64_t at = round + (uint64_t(slot) << shift);
+                return at <= _now ? 0 : static_cast<int64_t>(at - _now);
+            }
+            // Only timers parked beyond range of last level
+            const unsigned shift = BITS * LEVELS;
+            return static_cast<int64_t>((((_now >> shift) + 1) << shift) - _now);
+        }
+
+        // Moves time forward, calling expired(Timer&) for every due timer.
+        // Timer is disarmed before the call, so it may be scheduled again.
+        template<class F>
+        void advance(uint64_t now, F&& expired) {
+            if (!_count) {
+                if (_now < now) _now = now;
+                return;
+            }
+            while (_now < now) {
+                tick();
+                Link& head = _slots[0][_now & MASK];
+                while (head.next != &head) {
+                    Timer& timer = static_cast<Timer&>(*head.next);
+                    unlink(timer);
+                    --_count;
+                    expired(timer);
+                }
+                if (!_count) _now = now;
+            }
+        }
+
+    private:
+        // Noncopyable
+        TimerWheel(const TimerWheel&);
+
+        void operator=(TimerWheel&);
+
+        static constexpr unsigned BITS = 6;
+        static constexpr unsigned SLOTS = 1u << BITS;
+        static constexpr unsigned MASK = SLOTS - 1;
+        static constexpr unsigned LEVELS = 4;
+
+        // Level is the lowest one whose round contains both now and expires.
+        // Timer is never placed into current slot of a level (it would be
+        // reached next round only), except due ones during cascade.
+        void place(Timer& timer) {
+            const uint64_t expires = timer.expires < _now ? _now : timer.expires;
+            unsigned level = 0;
+            while (level < LEVELS && expires >> (BITS * (level + 1)) != _now >> (BITS * (level + 1)))
+                ++level;
+            unsigned index;
+            if (level < LEVELS) index = (expires >> (BITS * level)) & MASK;
+            else { // park in next slot of the last level, re-placed from there
+                level = LEVELS - 1;
+                index = ((_now >> (BITS * level)) + 1) & MASK;
+            }
+            Link& head = _slots[level][index];
+            timer.prev = head.prev;
+            timer.next = &head;
+            head.prev->next = &timer;
+            head.prev = &timer;
+            timer.slot = level * SLOTS + index;
+            _occupied[level] |= uint64_t(1) << index;
+        }
+
+        void unlink(Timer& timer) {
+            timer.prev->next = timer.next;
+            timer.next->prev = timer.prev;
+            const unsigned level = timer.slot / SLOTS, index = timer.slot % SLOTS;
+            const Link& head = _slots[level][index];
+            if (head.next == &head) _occupied[level] &= ~(uint64_t(1) << index);
+            timer.prev = timer.next = nullptr;
+        }
+
+        // Advances one tick, moving timers of reached higher-level slots down
+        void tick() {
+            ++_now;
+            unsigned top = 0;
+            while (top + 1 < LEVELS && !(_now & ((uint64_t(1) << BITS * (top + 1)) - 1)))
+                ++top;
+            for (unsigned level = top; 0 < level; --level) {
+                Link& head = _slots[level][(_now >> (BITS * level)) & MASK];
+                while (head.next != &head) {
+                    Timer& timer = static_cast<Timer&>(*head.next);
+                    unlink(timer);
+                    place(timer);
+                }
+            }
+        }
+
+        uint64_t _now;
+        uint64_t _count;
+        uint64_t _occupied[LEVELS];
+        Link _slots[LEVELS][SLOTS];
+    };
+}
+
+#endif
@@ -0,0 +1,143 @@
+/****************************************************************************
+  Copyright (C) 2015 Karol Roslaniec <mariacpp@roslaniec.net>
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not see <http://www.gnu.org/licenses>
+  or write to the Free Software Foundation, Inc.,
+  51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+*****************************************************************************/
+#ifndef MARIACPP_BOUNDED_RESULT_HPP
+#define MARIACPP_BOUNDED_RESULT_HPP
+
+#include <mysql.h>
+#include <mariacpp/bits/column_index.hpp>
+#include <mariacpp/bits/row_range.hpp>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace MariaCpp {
+
+    class ResultSet;
+
+    //  Materialized result with bounded memory usage, alternative
+    //  to store_result() for results of unknown size.
+    //  Rows of streamed result (use_result()) are read at once, and
+    //  kept in compact format (per cell varint length + 1, 0 for NULL,
+    //  followed by data) in memory up to memory_budget bytes; the
+    //  following rows are written to unlinked temporary file in tmpdir
+    //  (TMPDIR or /tmp by default), which is memory-mapped when all rows
+    //  are read, so that page cache holds them instead of process heap.
+    //  Index of row offsets (8 bytes per row) is always in memory.
+    //     std::unique_ptr<ResultSet> res(conn.use_result());
+    //     MariaCpp::BoundedResult rows(*res, 64 << 20);
+    //     rows.data_seek(rows.num_rows() - 1);
+    //     while (rows.next()) use(rows.getInt64(0), rows.getStringView(1));
+    class BoundedResult {
+    public:
+        typedef unsigned int idx_t;
+
+        BoundedResult(ResultSet& res, size_t memory_budget, const char* tmpdir = nullptr);
+
+        ~BoundedResult();
+
+        unsigned int num_fields() const { return _fields; }
+
+        my_ulonglong num_rows() const { return _offsets.size() - 1; }
+
+        // True if some rows did not fit into memory budget
+        bool spilled() const { return static_cast<bool>(_file); }
+
+        // Next row fetched by next() will be row number offset
+        void data_seek(my_ulonglong offset) { _next = offset; }
+
+        bool next();
+
+        RowCursor<BoundedResult> begin() { return RowCursor<BoundedResult>(this); }
+
+        std::default_sentinel_t end() const { return std::default_sentinel; }
+
+        // Case-insensitive, throws mariadb_error if not found
+        ColumnRef column(std::string_view name) const;
+
+        bool isNull(idx_t col) const {
+            assert_col(col);
+            return !_cells[col];
+        }
+
+        idx_t length(idx_t col) const {
+            assert_col(col);
+            return _lengths[col];
+        }
+
+        // Valid until the result is destroyed, NULL gives empty view
+        std::string_view getStringView(idx_t col) const {
+            assert_col(col);
+            return _cells[col] ? std::string_view(_cells[col], _lengths[col]) : std::string_view();
+        }
+
+        std::string getString(idx_t col) const { return std::string(getStringView(col)); }
+
+        int32_t getInt(idx_t col) const;
+
+        uint32_t getUInt(idx_t col) const;
+
+        int64_t getInt64(idx_t col) const;
+
+        uint64_t getUInt64(idx_t col) const;
+
+        bool getBoolean(idx_t col) const { return getInt(col); }
+
+        float getFloat(idx_t col) const;
+
+        double getDouble(idx_t col) const;
+
+    private:
+        // Noncopyable
+        BoundedResult(const BoundedResult&);
+
+        void operator=(BoundedResult&);
+
+        // Temporary file rows are spilled to (see bounded_result.cpp)
+        class File;
+
+        void assert_col(idx_t col) const {
+            assert(col < _fields);
+        }
+
+        void append(const MYSQL_ROW row, const unsigned long* lengths);
+
+        const char* row_data(my_ulonglong row) const;
+
+        const unsigned int _fields;
+        const size_t _memory_budget;
+        std::vector<bool> _unsigned;
+        ColumnIndex _columns;
+        std::vector<char> _memory; // rows within budget
+        std::unique_ptr<File> _file; // rows over budget, if any
+        const char* _map; // mapped _file
+        // Row offsets (rows + 1), offsets from _memory.size() are in _file
+        std::vector<uint64_t> _offsets;
+        std::vector<char> _encoded; // row being appended
+        my_ulonglong _next; // row fetched by next()
+        // Current row
+        std::vector<const char*> _cells;
+        std::vector<unsigned long> _lengths;
+    };
+}
+
+#endif
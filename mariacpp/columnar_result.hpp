@@ -0,0 +1,117 @@
+/****************************************************************************
+  Copyright (C) 2015 Karol Roslaniec <mariacpp@roslaniec.net>
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not see <http://www.gnu.org/licenses>
+  or write to the Free Software Foundation, Inc.,
+  51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+*****************************************************************************/
+#ifndef MARIACPP_COLUMNAR_RESULT_HPP
+#define MARIACPP_COLUMNAR_RESULT_HPP
+
+#include <mysql.h>
+#include <mariacpp/bits/column_index.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <string>
+#include <string_view>
+#include <vector>
+
+struct ArrowSchema;
+
+struct ArrowArray;
+
+namespace MariaCpp {
+
+    class PreparedStatement;
+
+    class ResultSet;
+
+    //  Result decoded column by column into contiguous arrays
+    //  (Apache Arrow-like layout): validity bitmap with bit set for
+    //  non-NULL values (LSB first), and either fixed-width values,
+    //  or offsets (rows + 1) into string data. NULL value is 0 (empty).
+    //  Numeric columns are parsed in batches of rows, column at a time
+    //  (see decode_int64()).
+    //     std::unique_ptr<ResultSet> res(conn.store_result());
+    //     MariaCpp::ColumnarResult cols(*res);
+    //     for (int64_t v: cols.column(0).int64s) sum += v;
+    class ColumnarResult {
+    public:
+        typedef unsigned int idx_t;
+
+        enum column_type {
+            COLUMN_INT64,  // signed integers and YEAR
+            COLUMN_UINT64, // unsigned integers
+            COLUMN_DOUBLE, // FLOAT and DOUBLE
+            COLUMN_STRING  // everything else, as sent by server
+        };
+
+        struct Column {
+            std::string name;
+            column_type type;
+            enum_field_types field_type;
+            bool binary; // binary charset (BLOB, BINARY...)
+            size_t null_count;
+            std::vector<uint8_t> validity;
+            std::vector<int64_t> int64s;   // COLUMN_INT64
+            std::vector<uint64_t> uint64s; // COLUMN_UINT64
+            std::vector<double> doubles;   // COLUMN_DOUBLE
+            std::vector<int64_t> offsets;  // COLUMN_STRING
+            std::vector<char> data;        // COLUMN_STRING
+
+            bool isNull(size_t row) const { return !(validity[row / 8] >> (row % 8) & 1); }
+
+            std::string_view getStringView(size_t row) const {
+                return std::string_view(data.data() + offsets[row], offsets[row + 1] - offsets[row]);
+            }
+        };
+
+        // Reads (remaining) rows of stored or streamed result, at most max_rows
+        explicit ColumnarResult(ResultSet& res, size_t max_rows = std::numeric_limits<size_t>::max());
+
+        // Same for executed statement. Values are copied from result
+        // binds row by row (binary protocol sends rows, not columns).
+        explicit ColumnarResult(PreparedStatement& stmt, size_t max_rows = std::numeric_limits<size_t>::max());
+
+        size_t rows() const { return _rows; }
+
+        idx_t columns() const { return static_cast<idx_t>(_columns.size()); }
+
+        const Column& column(idx_t col) const { return _columns.at(col); }
+
+        // Case-insensitive lookup, throws mariadb_error if not found
+        const Column& column(std::string_view name) const;
+
+    private:
+        // Rows of stored result are kept in memory by the client library,
+        // so cells can be collected for many rows and decoded per column.
+        static const size_t BATCH_ROWS = 1024;
+
+        void init(const MYSQL_FIELD* fields, idx_t count);
+
+        void append(Column& column, const char* const* cells, const unsigned long* lengths,
+                    size_t stride, size_t count);
+
+        void append(Column& column, const PreparedStatement& stmt, idx_t col);
+
+        friend void export_arrow(ColumnarResult&& result, ArrowSchema* schema, ArrowArray* array);
+
+        std::vector<Column> _columns;
+        ColumnIndex _index;
+        size_t _rows;
+    };
+}
+
+#endif
@@ -0,0 +1,96 @@
+/****************************************************************************
+  Copyright (C) 2015 Karol Roslaniec <mariacpp@roslaniec.net>
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not see <http://www.gnu.org/licenses>
+  or write to the Free Software Foundation, Inc.,
+  51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+*****************************************************************************/
+#ifndef MARIACPP_COLUMNS_HPP
+#define MARIACPP_COLUMNS_HPP
+
+#include <mariacpp/bits/column_index.hpp>
+#include <array>
+#include <cstddef>
+#include <string_view>
+
+namespace MariaCpp {
+
+    // String literal usable as template argument
+    template<size_t N>
+    struct fixed_string {
+        char data[N];
+
+        constexpr fixed_string(const char (&str)[N]) {
+            for (size_t i = 0; i < N; ++i) data[i] = str[i];
+        }
+
+        constexpr std::string_view view() const { return std::string_view(data, N - 1); }
+    };
+
+    //  Column names of fixed query declared once, resolved to indices
+    //  once per result (ResultSet or PreparedStatement):
+    //     MariaCpp::Columns<"id", "label"> cols(*res);
+    //     while (res->next()) use(res->getInt(cols.get<"id">()));
+    //  Column missing in result throws mariadb_error from constructor
+    //  (or bind()), name not declared in Columns doesn't compile.
+    template<fixed_string... Names>
+    class Columns {
+        static_assert(0 < sizeof...(Names), "no column names");
+
+    public:
+        Columns() : _refs() {}
+
+        // Constrained, so that copy of non-const Columns isn't bind()
+        template<class Result>
+            requires requires(Result& r) { r.column(std::string_view()); }
+        explicit Columns(Result& res) { bind(res); }
+
+        template<class Result>
+            requires requires(Result& r) { r.column(std::string_view()); }
+        void bind(Result& res) {
+            size_t i = 0;
+            ((_refs[i++] = res.column(Names.view())), ...);
+        }
+
+        template<fixed_string Name>
+        ColumnRef get() const { return _refs[position<Name>()]; }
+
+        ColumnRef operator[](size_t i) const { return _refs[i]; }
+
+        static constexpr size_t size() { return sizeof...(Names); }
+
+        // Position of Name in Names (case-insensitive, as in SQL)
+        template<fixed_string Name>
+        static consteval size_t position() {
+            constexpr std::string_view names[] = {Names.view()...};
+            for (size_t i = 0; i < sizeof...(Names); ++i)
+                if (equals(names[i], Name.view())) return i;
+            throw "column name not declared in Columns<...>";
+        }
+
+    private:
+        static constexpr bool equals(std::string_view a, std::string_view b) {
+            if (a.size() != b.size()) return false;
+            for (size_t i = 0; i < a.size(); ++i)
+                if (lower(a[i]) != lower(b[i])) return false;
+            return true;
+        }
+
+        static constexpr char lower(char c) { return 'A' <= c && c <= 'Z' ? c | 0x20 : c; }
+
+        std::array<ColumnRef, sizeof...(Names)> _refs;
+    };
+}
+
+#endif
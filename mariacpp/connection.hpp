@@ -21,8 +21,15 @@
 
 #include <mysql.h>
 #include <mysqld_error.h>
+#include <mariacpp/mariadb_error.hpp>
+#include <mariacpp/retry_policy.hpp>
+#include <mariacpp/statement_cache.hpp>
 #include <cassert>
+#include <memory>
 #include <string>
+#ifdef MARIADB_VERSION_ID
+#include <mariacpp/async.hpp>
+#endif
 
 namespace MariaCpp {
 
@@ -42,12 +49,14 @@ namespace MariaCpp {
 
         void autocommit(bool mode) {
             CC();
+            _dirty = true;
             if (mysql_autocommit(&mysql, mode)) throw_exception();
         }
 
         void change_user(const char* usr, const char* pas, const char* db) {
             CC();
             if (mysql_change_user(&mysql, usr, pas, db)) throw_exception();
+            clear_session();
         }
 
         const char* character_set_name() { return mysql_character_set_name(&mysql); }
@@ -66,6 +75,36 @@ namespace MariaCpp {
         void connect(const char* host, const char* user, const char* passwd, const char* db, unsigned int port, const char* unix_socket,
                      unsigned long clientflag);
 
+        // True if session state (transaction, variables, temporary tables,
+        // prepared statements...) might differ from a fresh connection.
+        // Set by every call that sends SQL or changes session settings
+        // (unless ReadOnly is in effect), cleared by connect(),
+        // change_user() and reset_connection().
+        bool dirty() const { return _dirty; }
+
+        //  Calls made while ReadOnly exists don't make connection dirty(),
+        //  so pooled connection used for plain SELECTs is returned
+        //  without reset:
+        //     MariaCpp::Connection::ReadOnly ro(*lease);
+        //     lease->query("SELECT ...");
+        //  Caller guarantees session state isn't changed; transaction
+        //  left open is still detected by ConnectionPool.
+        class ReadOnly {
+        public:
+            explicit ReadOnly(Connection& conn) : _conn(conn), _dirty(conn._dirty) {}
+
+            ~ReadOnly() { _conn._dirty = _dirty; }
+
+        private:
+            // Noncopyable
+            ReadOnly(const ReadOnly&);
+
+            void operator=(ReadOnly&);
+
+            Connection& _conn;
+            const bool _dirty;
+        };
+
         void dump_debug_info() {
             CC();
             if (mysql_dump_debug_info(&mysql)) throw_exception();
@@ -138,28 +177,64 @@ namespace MariaCpp {
 
         PreparedStatement* prepare(const std::string& sql);
 
+        // Enables LRU cache of up to capacity statements for prepare_cached()
+        // (0 disables it, which is the default). See StatementCache.
+        void set_statement_cache(size_t capacity);
+
+        // Like prepare(), but reuses statement already prepared for sql.
+        // Statement returns to the cache when the lease is destroyed.
+        StatementCache::Lease prepare_cached(const std::string& sql);
+
+#   ifdef MARIADB_VERSION_ID
+
+        // Prepares and executes statement in single round trip
+        // (mariadb_stmt_execute_direct), params are bound with
+        // PreparedStatement::set(). Result can be fetched as usual:
+        //     std::unique_ptr<PreparedStatement> stmt(
+        //         conn.execute_direct("SELECT name FROM t WHERE id=?", 42));
+        //     while (stmt->fetch()) ...
+        // Defined in prepared_stmt.hpp
+        template<class... Params>
+        PreparedStatement* execute_direct(const std::string& sql, const Params&... params);
+
+#   endif
+
+        // Failed query is retried according to retry_policy()
         void query(const char* sql) {
             CC();
-            if (mysql_query(&mysql, sql)) {
-                if (errorno() != ER_LOCK_DEADLOCK) {
-                    throw_exception();
-                }
-                query(sql);
-            }
+            _dirty = true;
+            for (unsigned attempt = 1; mysql_query(&mysql, sql); ++attempt)
+                if (!_retry->retry(attempt, errorno())) throw_exception();
         }
 
         void query(const char* sql, unsigned long length) {
             CC();
-            if (mysql_real_query(&mysql, sql, length)) {
-                if (errorno() != ER_LOCK_DEADLOCK) {
-                    throw_exception();
-                }
-                query(sql, length);
-            }
+            _dirty = true;
+            for (unsigned attempt = 1; mysql_real_query(&mysql, sql, length); ++attempt)
+                if (!_retry->retry(attempt, errorno())) throw_exception();
         }
 
+        // Policy for retrying query() and PreparedStatement::execute()
+        // (RetryPolicy::defaults() unless set). It must outlive connection.
+        void set_retry_policy(RetryPolicy& policy) { _retry = &policy; }
+
+        RetryPolicy& retry_policy() const { return *_retry; }
+
         void query(const std::string& sql) { return query(sql.data(), static_cast<unsigned long>(sql.size())); }
 
+        // Non-throwing variants of query() and next_result():
+        // error is returned as mariadb_error_code instead of thrown.
+        // Retryable errors are retried as query() does (see RetryPolicy),
+        // so call may sleep up to max_delay before each retry.
+        expected<void> try_query(const char* sql, unsigned long length) noexcept;
+
+        expected<void> try_query(const std::string& sql) noexcept { return try_query(sql.data(), static_cast<unsigned long>(sql.size())); }
+
+        expected<bool> try_next_result() noexcept;
+
+        // Error of last call, see mariadb_error_code
+        mariadb_error_code error_code() noexcept { return mariadb_error_code(&mysql); }
+
         // In MariaCpp: real_escape_string() == escape_string()
         unsigned long real_escape_string(char* to, const char* from, unsigned long length) {
             return mysql_real_escape_string(&mysql, to, from, length);
@@ -190,7 +265,11 @@ namespace MariaCpp {
 
 #   if 50700 <= MYSQL_VERSION_ID
 
-        void reset_connection() { if (mysql_reset_connection(&mysql)) throw_exception(); }
+        void reset_connection() {
+            CC();
+            if (mysql_reset_connection(&mysql)) throw_exception();
+            clear_session();
+        }
 
 #   endif
 
@@ -201,6 +280,7 @@ namespace MariaCpp {
 
         void select_db(const char* db) {
             CC();
+            _dirty = true;
             if (mysql_select_db(&mysql, db)) throw_exception();
         }
 
@@ -215,6 +295,7 @@ namespace MariaCpp {
 
         void set_character_set(const char* csname) {
             CC();
+            _dirty = true;
             if (mysql_set_character_set(&mysql, csname)) throw_exception();
         }
 
@@ -225,6 +306,7 @@ namespace MariaCpp {
 
         void set_server_option(enum enum_mysql_set_option option) {
             CC();
+            _dirty = true;
             if (mysql_set_server_option(&mysql, option)) throw_exception();
         }
 
@@ -260,6 +342,14 @@ namespace MariaCpp {
         //
         //  MariaDB-specific functions:
         //
+
+        // SERVER_STATUS_* flags of the last server reply (no round trip)
+        unsigned int server_status() {
+            unsigned int status = 0;
+            mariadb_get_infov(&mysql, MARIADB_CONNECTION_SERVER_STATUS, &status);
+            return status;
+        }
+
         //
         //  MariaDB-specific non-blocking functions:
         //  https://mariadb.com/kb/en/library/non-blocking-client-library/
@@ -329,6 +419,15 @@ namespace MariaCpp {
 
         void query_cont(int status);
 
+        // Non-throwing variants of above, see try_query()
+        expected<void> try_query_start(const char* sql, unsigned long length) noexcept;
+
+        expected<void> try_query_cont(int status) noexcept;
+
+        expected<bool> try_next_result_start() noexcept;
+
+        expected<bool> try_next_result_cont(int status) noexcept;
+
         void rollback_start();
 
         void rollback_cont(int status);
@@ -385,6 +484,35 @@ namespace MariaCpp {
 
         void reset_connection_cont(int status);
 
+        //
+        //  C++20 coroutine wrappers of _start()/_cont() pairs (see async.hpp):
+        //     co_await conn.connect_async(uri, user, passwd);
+        //     co_await conn.query_async("SELECT 1");
+        //  Arguments are copied into returned object, so they stay
+        //  valid until operation is finished.
+        //
+        Awaitable<void> autocommit_async(bool mode);
+
+        Awaitable<void> commit_async();
+
+        Awaitable<void> connect_async(const Uri& uri, const char* usr, const char* passwd, unsigned long clientflag = 0);
+
+        Awaitable<bool> next_result_async();
+
+        Awaitable<void> query_async(std::string sql);
+
+        Awaitable<void> rollback_async();
+
+        Awaitable<void> select_db_async(std::string db);
+
+        Awaitable<ResultSet*> store_result_async();
+
+        Awaitable<void> change_user_async(std::string usr, std::string pas, std::string db);
+
+        Awaitable<void> ping_async();
+
+        Awaitable<void> reset_connection_async();
+
 #   endif
 
     private:
@@ -395,7 +523,15 @@ namespace MariaCpp {
 
         inline void CC();
 
+        // Session was reset: clean, and without prepared statements
+        void clear_session();
+
+        friend class ConnectionPool; // pool statements don't make it dirty()
+
         MYSQL mysql;
+        bool _dirty;
+        RetryPolicy* _retry;
+        std::unique_ptr<StatementCache> _stmt_cache;
 #   ifdef MARIADB_VERSION_ID
 
         friend class PreparedStatement;
@@ -0,0 +1,212 @@
+/****************************************************************************
+  Copyright (C) 2015 Karol Roslaniec <mariacpp@roslaniec.net>
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not see <http://www.gnu.org/licenses>
+  or write to the Free Software Foundation, Inc.,
+  51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+*****************************************************************************/
+#ifndef MARIACPP_CONNECTION_POOL_HPP
+#define MARIACPP_CONNECTION_POOL_HPP
+
+#include <mariacpp/connection.hpp>
+#include <mariacpp/uri.hpp>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace MariaCpp {
+
+    //  Pool of connections sharing the same connect() arguments.
+    //
+    //  Free connections are kept in per-core shards. Each shard is
+    //  a lock-free stack of slot indices, so acquire() and release
+    //  cost a few atomic operations and never take a mutex.
+    //  If the shard of the calling thread is empty, connections
+    //  are stolen from other shards.
+    //  Connections are opened lazily, on first acquire() of given slot.
+    //
+    //  Connection returned dirty (see Connection::dirty()) is recycled
+    //  with reset_connection() instead of reconnect. With MariaDB
+    //  the reset request is only sent on return (reset_connection_start())
+    //  and its reply is collected by the next acquire(), so neither side
+    //  waits a full round trip. Clean connections skip reset entirely.
+    //
+    //  warm_up() opens connections up front. All handshakes (and
+    //  preparing of set_statements()) run concurrently from the calling
+    //  thread, so start-up takes about one handshake instead of N.
+    //  Statements prepared by the pool are available via
+    //  Lease::statement(i). They don't make connection dirty(), but are
+    //  lost (and lazily re-prepared) if the connection has to be reset.
+    //  Open transaction is detected on return from server_status().
+    //
+    //  As with plain Connection, every thread using the pool
+    //  must call thread_init() first (see scoped_thread_init).
+    //  Sample usage:
+    //     ConnectionPool pool(Uri(uri), user, passwd, 16);
+    //     {
+    //         ConnectionPool::Lease conn = pool.acquire();
+    //         conn->query("SELECT 1");
+    //     } // connection goes back to the pool
+    //
+    class ConnectionPool {
+    public:
+        class Lease;
+
+        ConnectionPool(const Uri& uri, const char* user, const char* passwd, size_t size, unsigned long clientflag = 0);
+
+        ~ConnectionPool(); // all leases must be returned before
+
+        // Blocks until a connection is available.
+        Lease acquire();
+
+        // Returns empty Lease if all connections are checked out.
+        Lease try_acquire();
+
+        // Called on every new Connection just before connect(),
+        // e.g. to set options(). Must be set before first acquire().
+        void set_initializer(std::function<void(Connection&)> init) { _init = std::move(init); }
+
+        // Default: true. If false, connections are returned as they are.
+        void set_reset_on_return(bool reset) { _reset_on_return = reset; }
+
+        // SQL prepared on every connection, see Lease::statement(i).
+        // Must be set before first acquire().
+        void set_statements(std::vector<std::string> sqls) { _statements = std::move(sqls); }
+
+        // Opens up to count (0 = all) not yet connected free connections
+        // concurrently, and prepares set_statements() on each of them.
+        // Returns number of connections opened; rethrows first error
+        // (after all other handshakes are done).
+        size_t warm_up(size_t count = 0);
+
+        size_t size() const { return _size; }
+
+        // Approximate number of connections ready for checkout
+        size_t available() const { return _available.load(std::memory_order_relaxed); }
+
+    private:
+        // Noncopyable
+        ConnectionPool(const ConnectionPool&);
+
+        void operator=(ConnectionPool&);
+
+        static constexpr uint32_t npos = ~uint32_t();
+
+        struct Slot {
+            std::optional<Connection> conn;
+            std::atomic<uint32_t> next; // index + 1 of next free slot
+            bool reset_pending; // reset_connection_cont() not finished yet
+            std::vector<std::unique_ptr<PreparedStatement>> stmts;
+        };
+
+        struct alignas(64) Shard {
+            // Tagged stack top: tag << 32 | (slot index + 1)
+            std::atomic<uint64_t> head;
+        };
+
+        inline Shard& local_shard();
+
+        uint32_t pop(Shard& shard);
+
+        void push(Shard& shard, uint32_t idx);
+
+        uint32_t take();
+
+        void open(Slot& slot);
+
+        static void drop(Slot& slot) noexcept;
+
+        Lease lease(uint32_t idx);
+
+        void recycle(Slot& slot) noexcept;
+
+        void release(uint32_t idx);
+
+        const Uri _uri;
+        const std::string _user;
+        const std::string _passwd;
+        const unsigned long _clientflag;
+        const size_t _size;
+        const size_t _shard_count;
+        std::unique_ptr<Slot[]> _slots;
+        std::unique_ptr<Shard[]> _shards;
+        std::atomic<size_t> _available;
+        std::atomic<uint32_t> _releases; // bumped on every release()
+        std::function<void(Connection&)> _init;
+        std::vector<std::string> _statements;
+        bool _reset_on_return;
+    };
+
+    //  RAII handle to a checked out Connection.
+    //  Destructor gives the connection back to the pool.
+    class ConnectionPool::Lease {
+    public:
+        Lease() : _pool(), _idx(npos) {}
+
+        Lease(Lease&& other) noexcept : _pool(other._pool), _idx(other._idx) {
+            other._pool = nullptr;
+            other._idx = npos;
+        }
+
+        Lease& operator=(Lease&& other) noexcept {
+            if (this != &other) {
+                release();
+                std::swap(_pool, other._pool);
+                std::swap(_idx, other._idx);
+            }
+            return *this;
+        }
+
+        ~Lease() { release(); }
+
+        Connection* get() const { return _pool ? &*_pool->_slots[_idx].conn : nullptr; }
+
+        Connection& operator*() const { return *get(); }
+
+        Connection* operator->() const { return get(); }
+
+        explicit operator bool() const { return _pool; }
+
+        // i-th statement of ConnectionPool::set_statements()
+        PreparedStatement& statement(size_t i) const;
+
+        // Return connection to the pool before end of scope
+        void release() {
+            if (!_pool) return;
+            _pool->recycle(_pool->_slots[_idx]);
+            _pool->release(_idx);
+            _pool = nullptr;
+            _idx = npos;
+        }
+
+    private:
+        friend class ConnectionPool;
+
+        Lease(ConnectionPool* pool, uint32_t idx) : _pool(pool), _idx(idx) {}
+
+        // Noncopyable
+        Lease(const Lease&);
+
+        void operator=(const Lease&);
+
+        ConnectionPool* _pool;
+        uint32_t _idx;
+    };
+}
+#endif
@@ -19,6 +19,8 @@
 #ifndef MARIACPP_MARIADB_ERROR_HPP
 #define MARIACPP_MARIADB_ERROR_HPP
 
+#include <cstring>
+#include <expected>
 #include <iostream>
 #include <stdexcept>
 #include <iosfwd>
@@ -28,17 +30,32 @@
 #include <mysql.h>
 
 namespace MariaCpp {
+    //  Error categories, selecting subclass of mariadb_error
+    //  and whether its stack trace is captured.
+    enum error_category : unsigned {
+        ERROR_OTHER = 1,
+        ERROR_CONNECTION = 2, // connection lost or refused
+        ERROR_LOCK = 4,       // deadlock or lock wait timeout
+        ERROR_INTEGRITY = 8,  // SQLSTATE 23: duplicate key, foreign key...
+        ERROR_SYNTAX = 16,    // SQLSTATE 42: syntax error, unknown table...
+        ERROR_DATA = 32,      // SQLSTATE 22: out of range, truncation...
+        ERROR_ARGUMENT = 64,  // InvalidArgumentException
+        ERROR_ALL = 127
+    };
+
     class mariadb_error : public std::runtime_error {
     public:
+        static constexpr unsigned category = ERROR_OTHER;
+
         mariadb_error(const char* str, unsigned number, const char* sqlstate,
-					  std::stacktrace stacktrace=std::stacktrace::current())
+					  std::stacktrace stacktrace=current_stacktrace(category))
 		: std::runtime_error(str), errno_(number), sqlstate_(sqlstate), stacktrace_(std::move(stacktrace)) { }
 
         explicit mariadb_error(MYSQL* con) : mariadb_error(mysql_error(con), mysql_errno(con), mysql_sqlstate(con)) {}
 
         explicit mariadb_error(MYSQL_STMT* con) : mariadb_error(mysql_stmt_error(con), mysql_stmt_errno(con), mysql_stmt_sqlstate(con)) {}
 
-        explicit mariadb_error(const std::string& reason, std::stacktrace stacktrace=std::stacktrace::current())
+        explicit mariadb_error(const std::string& reason, std::stacktrace stacktrace=current_stacktrace(category))
 		: std::runtime_error(reason), errno_(0), stacktrace_(std::move(stacktrace)) { }
 
         void print(std::ostream& os) const {
@@ -50,8 +67,31 @@ namespace MariaCpp {
 
         [[nodiscard]] unsigned errorno() const { return errno_; }
 
+        [[nodiscard]] const std::string& sqlstate() const { return sqlstate_; }
+
+        // Empty unless capturing was enabled for category of this error
 		[[nodiscard]] std::stacktrace const& get_stacktrace() const { return stacktrace_; }
 
+        // Stack traces are expensive, so they are not captured by default.
+        // Enables (or disables) capturing for given error_category mask.
+        static void capture_stacktrace(unsigned categories, bool enable = true);
+
+        // Same for single error class, e.g. capture_stacktrace<lock_error>()
+        template<class E>
+        static void capture_stacktrace(bool enable = true) { capture_stacktrace(E::category, enable); }
+
+        static bool captures_stacktrace(unsigned category);
+
+        static std::stacktrace current_stacktrace(unsigned category) {
+            return captures_stacktrace(category) ? std::stacktrace::current(1) : std::stacktrace();
+        }
+
+        // Category of error reported by server or client library
+        static error_category classify(unsigned number, const char* sqlstate);
+
+        // Throws subclass of mariadb_error matching classify()
+        [[noreturn]] static void raise(const char* str, unsigned number, const char* sqlstate);
+
     private:
         const unsigned errno_;
         std::string sqlstate_;
@@ -62,9 +102,67 @@ namespace MariaCpp {
         return ex.print(os), os;
     }
 
+    // Error of given error_category, see typedefs below
+    template<unsigned Category>
+    class categorized_error : public mariadb_error {
+    public:
+        static constexpr unsigned category = Category;
+
+        categorized_error(const char* str, unsigned number, const char* sqlstate,
+                          std::stacktrace stacktrace = current_stacktrace(category))
+                : mariadb_error(str, number, sqlstate, std::move(stacktrace)) {}
+    };
+
+    typedef categorized_error<ERROR_CONNECTION> connection_error;
+
+    typedef categorized_error<ERROR_LOCK> lock_error;
+
+    typedef categorized_error<ERROR_INTEGRITY> integrity_error;
+
+    typedef categorized_error<ERROR_SYNTAX> syntax_error;
+
+    typedef categorized_error<ERROR_DATA> data_error;
+
     class InvalidArgumentException final : public mariadb_error {
     public:
-        explicit InvalidArgumentException(const std::string& reason) : mariadb_error(reason) {}
+        static constexpr unsigned category = ERROR_ARGUMENT;
+
+        explicit InvalidArgumentException(const std::string& reason)
+                : mariadb_error(reason, current_stacktrace(category)) {}
+    };
+
+    //  Error returned (not thrown) by noexcept try_*() methods, e.g.
+    //     auto res = stmt.try_execute();
+    //     if (!res && res.error().category() == ERROR_INTEGRITY) ...
+    //  message points to error buffer of connection (or statement)
+    //  and is valid only until next call on it.
+    struct mariadb_error_code {
+        unsigned number;
+        char sqlstate[6];
+        const char* message;
+
+        mariadb_error_code(const char* str, unsigned err_no, const char* state) noexcept
+                : number(err_no), sqlstate(), message(str) {
+            if (state) std::strncpy(sqlstate, state, sizeof(sqlstate) - 1);
+        }
+
+        explicit mariadb_error_code(MYSQL* con) noexcept
+                : mariadb_error_code(mysql_error(con), mysql_errno(con), mysql_sqlstate(con)) {}
+
+        explicit mariadb_error_code(MYSQL_STMT* stmt) noexcept
+                : mariadb_error_code(mysql_stmt_error(stmt), mysql_stmt_errno(stmt), mysql_stmt_sqlstate(stmt)) {}
+
+        [[nodiscard]] error_category category() const { return mariadb_error::classify(number, sqlstate); }
+
+        // Throws it as mariadb_error after all
+        [[noreturn]] void raise() const { mariadb_error::raise(message, number, sqlstate); }
     };
+
+    inline std::ostream& operator<<(std::ostream& os, const mariadb_error_code& err) {
+        return os << "MariaDB SQL ERROR " << err.number << " (" << err.sqlstate << ") " << err.message;
+    }
+
+    template<class T>
+    using expected = std::expected<T, mariadb_error_code>;
 }
 #endif
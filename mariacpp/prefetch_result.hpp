@@ -0,0 +1,155 @@
+/****************************************************************************
+  Copyright (C) 2015 Karol Roslaniec <mariacpp@roslaniec.net>
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not see <http://www.gnu.org/licenses>
+  or write to the Free Software Foundation, Inc.,
+  51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+*****************************************************************************/
+#ifndef MARIACPP_PREFETCH_RESULT_HPP
+#define MARIACPP_PREFETCH_RESULT_HPP
+
+#include <mysql.h>
+#include <mariacpp/bits/column_index.hpp>
+#include <mariacpp/bits/row_range.hpp>
+#include <atomic>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+namespace MariaCpp {
+
+    class ResultSet;
+
+    //  Streamed result (use_result()) read ahead by background thread,
+    //  so network reads overlap with processing of rows.
+    //  Reader thread copies rows into batches of batch_rows rows, and
+    //  passes them through single-producer single-consumer ring of
+    //  capacity batches (including the one being consumed); when ring
+    //  is full, reader waits and server is throttled by TCP flow control.
+    //     std::unique_ptr<ResultSet> res(conn.use_result());
+    //     MariaCpp::PrefetchResult rows(*res);
+    //     while (rows.next()) use(rows.getInt64(0), rows.getStringView(1));
+    //  Neither result nor its connection may be used until PrefetchResult
+    //  is destroyed. Destroying it early stops the reader after current
+    //  row; remaining rows are discarded when result is freed.
+    //  Read error is thrown by next() after already read rows.
+    class PrefetchResult {
+    public:
+        typedef unsigned int idx_t;
+
+        explicit PrefetchResult(ResultSet& res, size_t batch_rows = 256, size_t capacity = 4);
+
+        ~PrefetchResult();
+
+        unsigned int num_fields() const { return _fields; }
+
+        bool next();
+
+        RowCursor<PrefetchResult> begin() { return RowCursor<PrefetchResult>(this); }
+
+        std::default_sentinel_t end() const { return std::default_sentinel; }
+
+        // Case-insensitive, throws mariadb_error if not found
+        ColumnRef column(std::string_view name) const;
+
+        bool isNull(idx_t col) const { return NPOS == offset(col); }
+
+        idx_t length(idx_t col) const {
+            assert_col(col);
+            return _batch->lengths[_cell + col];
+        }
+
+        // Valid until next(), NULL gives empty view
+        std::string_view getStringView(idx_t col) const {
+            const size_t off = offset(col);
+            return NPOS == off ? std::string_view() : std::string_view(_batch->data.data() + off, length(col));
+        }
+
+        std::string getString(idx_t col) const { return std::string(getStringView(col)); }
+
+        int32_t getInt(idx_t col) const;
+
+        uint32_t getUInt(idx_t col) const;
+
+        int64_t getInt64(idx_t col) const;
+
+        uint64_t getUInt64(idx_t col) const;
+
+        bool getBoolean(idx_t col) const { return getInt(col); }
+
+        float getFloat(idx_t col) const;
+
+        double getDouble(idx_t col) const;
+
+    private:
+        // Noncopyable
+        PrefetchResult(const PrefetchResult&);
+
+        void operator=(PrefetchResult&);
+
+        static constexpr size_t NPOS = static_cast<size_t>(-1);
+
+        // Cells of rows, row-major; offset into data (NPOS if NULL).
+        // Cells are NUL terminated, as rows of MYSQL_RES.
+        struct Batch {
+            std::vector<char> data;
+            std::vector<size_t> offsets;
+            std::vector<unsigned long> lengths;
+            size_t rows;
+            bool last; // no more batches
+        };
+
+        void assert_col(idx_t col) const {
+            assert(col < _fields && _batch);
+        }
+
+        size_t offset(idx_t col) const {
+            assert_col(col);
+            return _batch->offsets[_cell + col];
+        }
+
+        bool finish();
+
+        void read();
+
+        bool fill(Batch& batch);
+
+        ResultSet& _res;
+        const unsigned int _fields;
+        const size_t _batch_rows;
+        std::vector<bool> _unsigned;
+        ColumnIndex _columns;
+        std::unique_ptr<Batch[]> _ring;
+        const size_t _capacity;
+        // Batches [_head, _tail) are ready, _head is consumed; kept
+        // on separate cache lines, as each is written by other thread.
+        alignas(64) std::atomic<size_t> _head;
+        alignas(64) std::atomic<size_t> _tail;
+        std::atomic<bool> _stop;
+        std::exception_ptr _error; // set by reader before last batch
+        // Consumer state
+        const Batch* _batch; // current batch, null before first next()
+        size_t _row;
+        size_t _cell; // _row * _fields
+        std::thread _reader;
+    };
+}
+
+#endif
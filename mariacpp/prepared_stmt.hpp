@@ -20,9 +20,21 @@
 #define MARIACPP_PREPARED_STATEMENT_HPP
 
 #include <mysql.h>
+#include <mariacpp/connection.hpp>
+#include <mariacpp/bits/column_index.hpp>
+#include <mariacpp/bits/row_range.hpp>
 #include <cstdint>
+#include <memory>
+#include <span>
 #include <string>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
 #include <vector>
+#include <mariacpp/bits/row_binding.hpp>
+#ifdef MARIADB_VERSION_ID
+#include <mariacpp/async.hpp>
+#endif
 
 namespace MariaCpp {
 
@@ -48,6 +60,8 @@ namespace MariaCpp {
 
         void attr_set(enum enum_stmt_attr_type option, const void* arg);
 
+        Connection& connection() const { return _conn; }
+
         // Optional C-style param binding
         void bind_param(MYSQL_BIND* bind);
 
@@ -73,6 +87,47 @@ namespace MariaCpp {
 
         void fetch_column(Bind& bind, unsigned int column, unsigned long offset);
 
+        //  Binds result columns straight to members of row (one Field
+        //  per column), so fetch() decodes into it without copying:
+        //     struct Item { int32_t id; char name[32]; unsigned long name_len; char name_null; };
+        //     stmt->bindResult(item, field(&Item::id), field(&Item::name, &Item::name_len, &Item::name_null));
+        //     while (stmt->fetch()) use(item);
+        //  Without fields, row_mapping<Row>::fields() is used. Longer
+        //  strings are truncated (see truncated()), length is the full one.
+        //  Getters can't be used until statement is prepared (or reset) again.
+        template<class Row, class... T>
+        void bindResult(Row& row, const Field<Row, T>&... fields) {
+            static_assert(0 < sizeof...(T), "bindResult() needs at least one field");
+            static_assert((!std::is_pointer_v<T> && ...), "Result can't be fetched into pointer member, use char[N]");
+            MYSQL_BIND binds[sizeof...(T)];
+            idx_t col = 0;
+            (initResultField(binds[col++], bind_type<T>::is_unsigned, fields.type, &(row.*fields.value), sizeof(T),
+                             fields.length ? &(row.*fields.length) : nullptr,
+                             fields.indicator ? &(row.*fields.indicator) : nullptr), ...);
+            bindResult(&row, binds, col);
+        }
+
+        template<class Row>
+        void bindResult(Row& row) {
+            std::apply([&](const auto&... fields) { bindResult(row, fields...); }, row_mapping<Row>::fields());
+        }
+
+        // Fetches next row into row, binding it (see bindResult()) first if needed
+        template<class Row>
+        bool fetch_into(Row& row) {
+            if (_bound_row != &row) bindResult(row);
+            return fetch();
+        }
+
+        // Input range of rows, see ResultSet::begin()
+        RowCursor<PreparedStatement> begin() { return RowCursor<PreparedStatement>(this); }
+
+        std::default_sentinel_t end() const { return std::default_sentinel; }
+
+        // Rows decoded to tuples, see ResultSet::rows()
+        template<class... Ts>
+        RowRange<PreparedStatement, Ts...> rows() { return RowRange<PreparedStatement, Ts...>(*this); }
+
         unsigned int field_count() const { return mysql_stmt_field_count(_stmt); }
 
 #   if 50500 <= MYSQL_VERSION_ID
@@ -85,6 +140,19 @@ namespace MariaCpp {
 
         bool next_result();
 
+        // Non-throwing variants of execute(), fetch() and next_result():
+        // error is returned as mariadb_error_code instead of thrown.
+        // try_execute() retries as execute() does (see RetryPolicy),
+        // so it may sleep up to max_delay before each retry.
+        expected<void> try_execute() noexcept;
+
+        expected<bool> try_fetch() noexcept;
+
+        expected<bool> try_next_result() noexcept;
+
+        // Error of last call, see mariadb_error_code
+        mariadb_error_code error_code() const noexcept { return mariadb_error_code(_stmt); }
+
         my_ulonglong num_rows() const { return mysql_stmt_num_rows(_stmt); }
 
         unsigned long param_count() const { return mysql_stmt_param_count(_stmt); }
@@ -93,6 +161,8 @@ namespace MariaCpp {
         // Use: Connection::prepare(const std::string &)
         void prepare(const std::string& sql);
 
+        // Also frees params set by set*(), which have to be set again
+        // before next execute() (InvalidArgumentException otherwise)
         void reset();
 
         ResultSet* result_metadata();
@@ -169,12 +239,104 @@ namespace MariaCpp {
 
         void setTimeStamp(idx_t col, const Time& time) { return setDateTime(col, time); }
 
+        // Generic setter choosing set*() method by type of value;
+        // nullptr and empty std::optional set NULL.
+        template<class T>
+        void set(idx_t col, const T& value);
+
+#   ifdef MARIADB_VERSION_ID
+
+        //
+        //  Bulk execution (MariaDB only): bind one array per column
+        //  and send all rows in single round trip with executeBatch(rows).
+        //  Arrays are not copied and must stay valid during executeBatch().
+        //  Optional indicators array holds STMT_INDICATOR_NONE/NULL/DEFAULT
+        //  per row. Sample:
+        //     int32_t ids[] = {1, 2, 3};
+        //     const char* labels[] = {"a", "b", nullptr};
+        //     unsigned long lengths[] = {1, 1, 0};
+        //     char ind[] = {STMT_INDICATOR_NONE, STMT_INDICATOR_NONE, STMT_INDICATOR_NULL};
+        //     stmt->setArray(0, ids);
+        //     stmt->setArray(1, labels, lengths, ind);
+        //     stmt->executeBatch(3);
+        //
+
+        // Number of params bound before statement is prepared, which is
+        // needed by execute_direct() (STMT_ATTR_PREBIND_PARAMS)
+        void prebind_params(unsigned int count);
+
+        // Prepares and executes sql in single round trip. Params have to be
+        // set before (after prebind_params()). Statement stays prepared.
+        void execute_direct(const std::string& sql);
+
+        void setArray(idx_t col, const int8_t* values, const char* indicators = nullptr);
+
+        void setArray(idx_t col, const uint8_t* values, const char* indicators = nullptr);
+
+        void setArray(idx_t col, const int16_t* values, const char* indicators = nullptr);
+
+        void setArray(idx_t col, const uint16_t* values, const char* indicators = nullptr);
+
+        void setArray(idx_t col, const int32_t* values, const char* indicators = nullptr);
+
+        void setArray(idx_t col, const uint32_t* values, const char* indicators = nullptr);
+
+        void setArray(idx_t col, const int64_t* values, const char* indicators = nullptr);
+
+        void setArray(idx_t col, const uint64_t* values, const char* indicators = nullptr);
+
+        void setArray(idx_t col, const float* values, const char* indicators = nullptr);
+
+        void setArray(idx_t col, const double* values, const char* indicators = nullptr);
+
+        // lengths[i] is length of values[i]; null lengths is rejected
+        // with InvalidArgumentException
+        void setArray(idx_t col, const char* const* values, const unsigned long* lengths, const char* indicators = nullptr);
+
+        // type: MYSQL_TYPE_DATE, MYSQL_TYPE_TIME or MYSQL_TYPE_DATETIME.
+        // Connector reads temporal (as string) arrays as array of pointers.
+        void setArray(idx_t col, const MYSQL_TIME* const* values, enum_field_types type, const char* indicators = nullptr);
+
+        // Executes statement once for each of rows bound with setArray(),
+        // throws InvalidArgumentException if any param is bound otherwise
+        void executeBatch(unsigned int rows);
+
+        //  Row-wise bulk execution straight from array of structs
+        //  (STMT_ATTR_ROW_SIZE), one Field per parameter, no copy:
+        //     struct Item { int32_t id; char name[32]; unsigned long name_len; };
+        //     stmt->executeRows(std::span(items), field(&Item::id),
+        //                       field(&Item::name, &Item::name_len));
+        //  Without fields, row_mapping<Row>::fields() is used.
+        template<class Row, size_t N, class... T>
+        void executeRows(std::span<Row, N> rows, const Field<std::remove_const_t<Row>, T>&... fields) {
+            if (rows.empty()) return;
+            idx_t col = 0;
+            (setRowField(col++, bind_type<T>::is_unsigned, fields.type, &(rows.front().*fields.value),
+                         fields.length ? &(rows.front().*fields.length) : nullptr,
+                         fields.indicator ? &(rows.front().*fields.indicator) : nullptr), ...);
+            executeRows(sizeof(Row), rows.size(), col);
+        }
+
+        template<class Row, size_t N>
+        void executeRows(std::span<Row, N> rows) {
+            std::apply([&](const auto&... fields) { executeRows(rows, fields...); },
+                       row_mapping<std::remove_const_t<Row>>::fields());
+        }
+
+#   endif
+
         bool isNull(idx_t col) const;
 
         std::string getString(idx_t col) const;
 
         std::string getBinary(idx_t col) const { return getString(col); }
 
+        // Zero-copy access to string/blob column, valid until next fetch()
+        // (debug builds overwrite the data then). NULL gives empty view.
+        std::string_view getStringView(idx_t col) const;
+
+        std::span<const std::byte> getBytes(idx_t col) const { return std::as_bytes(std::span(getStringView(col))); }
+
         int32_t getInt(idx_t col) const;
 
         uint32_t getUInt(idx_t col) const;
@@ -197,35 +359,43 @@ namespace MariaCpp {
 
         Time getTimeStamp(idx_t col) const; // same as getDateTime(col)
 
-        std::string getString(const std::string& col) const;
+        std::string getString(std::string_view col) const;
+
+        std::string getBinary(std::string_view col) const { return getString(col); }
+
+        std::string_view getStringView(std::string_view col) const;
+
+        std::span<const std::byte> getBytes(std::string_view col) const { return std::as_bytes(std::span(getStringView(col))); }
 
-        std::string getBinary(const std::string& col) const { return getString(col); }
+        int32_t getInt(std::string_view col) const;
 
-        int32_t getInt(const std::string& col) const;
+        uint32_t getUInt(std::string_view col) const;
 
-        uint32_t getUInt(const std::string& col) const;
+        int64_t getInt64(std::string_view col) const;
 
-        int64_t getInt64(const std::string& col) const;
+        uint64_t getUInt64(std::string_view col) const;
 
-        uint64_t getUInt64(const std::string& col) const;
+        bool getBoolean(std::string_view col) const { return getInt(col); }
 
-        bool getBoolean(const std::string& col) const { return getInt(col); }
+        float getFloat(std::string_view col) const;
 
-        float getFloat(const std::string& col) const;
+        double getDouble(std::string_view col) const;
 
-        double getDouble(const std::string& col) const;
+        Time getDate(std::string_view col) const; // same as getDateTime(col)
 
-        Time getDate(const std::string& col) const; // same as getDateTime(col)
+        Time getDateTime(std::string_view col) const;
 
-        Time getDateTime(const std::string& col) const;
+        Time getTime(std::string_view col) const; // same as getDateTime(col)
 
-        Time getTime(const std::string& col) const; // same as getDateTime(col)
+        Time getTimeStamp(std::string_view col) const; // same as getDateTime(col)
 
-        Time getTimeStamp(const std::string& col) const; // same as getDateTime(col)
+		bool isNull(std::string_view col) const;
 
-		bool isNull(const std::string& col) const;
+        int getFieldIndexByName(std::string_view name) const;
 
-        int getFieldIndexByName(const std::string& name) const;
+        // Resolves column name once (binds results if not done yet),
+        // see ColumnRef
+        ColumnRef column(std::string_view name);
 
 #   ifdef MARIADB_VERSION_ID
 
@@ -263,6 +433,20 @@ namespace MariaCpp {
 
         void reset_cont(int status);
 
+        // Non-throwing variants of *_start()/*_cont(), see try_execute()
+        expected<void> try_execute_start() noexcept;
+
+        expected<void> try_execute_cont(int status) noexcept;
+
+        expected<bool> try_fetch_start() noexcept;
+
+        expected<bool> try_fetch_cont(int status) noexcept;
+
+        // Result is true until operation completes (async_status() is 0)
+        expected<bool> try_next_result_start() noexcept;
+
+        expected<bool> try_next_result_cont(int status) noexcept;
+
         void free_result_start();
 
         void free_result_cont(int status);
@@ -271,6 +455,21 @@ namespace MariaCpp {
 
         void send_long_data_cont(int status);
 
+        // Coroutine wrappers, see Connection::query_async()
+        Awaitable<bool> next_result_async();
+
+        Awaitable<void> prepare_async(std::string sql);
+
+        Awaitable<void> execute_async();
+
+        Awaitable<bool> fetch_async();
+
+        Awaitable<void> store_result_async();
+
+        Awaitable<void> reset_async();
+
+        Awaitable<void> free_result_async();
+
 #   endif
 
     private:
@@ -281,26 +480,89 @@ namespace MariaCpp {
 
         void throw_exception() const;
 
+        mariadb_error_code caught_error() const noexcept;
+
+        expected<bool> try_fetched(int ret) noexcept;
+
         inline Bind& param(idx_t col);
 
         inline const Bind& result(idx_t col) const;
 
         inline void do_reset_bind();
 
+#   ifdef MARIADB_VERSION_ID
+
+        void setRowField(idx_t col, bool is_unsigned, enum_field_types type, const void* value,
+                         const unsigned long* length, const char* indicator);
+
+        void executeRows(size_t row_size, size_t rows, idx_t columns);
+
+#   endif
+
+        void initResultField(MYSQL_BIND& bind, bool is_unsigned, enum_field_types type, void* value,
+                             unsigned long size, unsigned long* length, char* is_null);
+
+        void bindResult(const void* row, MYSQL_BIND* binds, idx_t columns);
+
+        void report_truncation();
+
         inline void do_bind_params();
 
         inline void do_bind_results();
 
         inline void do_rebind_results();
 
+        inline void do_expire_views();
+
         Connection& _conn;
         MYSQL_STMT* _stmt;
         Bind* _params;
         Bind* _results;
         bool _truncated;
         bool _bind_params; // C++ style binding
+        bool _params_reset; // C++ style params freed by reset()
         bool _bind_results;
-        std::vector<std::string> _col_names;
+        unsigned int _prebind; // params count before prepare
+        ColumnIndex _columns;
+        const void* _bound_row; // see bindResult()
     };
+
+    template<class T>
+    void PreparedStatement::set(idx_t col, const T& value) {
+        if constexpr (std::is_same_v<T, std::nullptr_t>) setNull(col);
+        else if constexpr (std::is_same_v<T, bool>) setBoolean(col, value);
+        else if constexpr (std::is_same_v<T, char>) setChar(col, value);
+        else if constexpr (std::is_integral_v<T> && std::is_signed_v<T>) {
+            if constexpr (sizeof(T) == 1) setTinyInt(col, value);
+            else if constexpr (sizeof(T) == 2) setSmallInt(col, value);
+            else if constexpr (sizeof(T) == 4) setInt(col, value);
+            else setInt64(col, value);
+        } else if constexpr (std::is_integral_v<T>) {
+            if constexpr (sizeof(T) == 1) setUTinyInt(col, value);
+            else if constexpr (sizeof(T) == 2) setUSmallInt(col, value);
+            else if constexpr (sizeof(T) == 4) setUInt(col, value);
+            else setUInt64(col, value);
+        } else if constexpr (std::is_same_v<T, float>) setFloat(col, value);
+        else if constexpr (std::is_same_v<T, double>) setDouble(col, value);
+        else if constexpr (std::is_same_v<T, const char*> || std::is_same_v<T, char*>) setString(col, value);
+        else if constexpr (std::is_convertible_v<const T&, std::string_view>) setString(col, std::string_view(value));
+        else if constexpr (std::is_base_of_v<MYSQL_TIME, T>) setDateTime(col, value);
+        else if constexpr (requires { value.has_value(); *value; }) {
+            if (value.has_value()) set(col, *value);
+            else setNull(col);
+        } else static_assert(sizeof(T) == 0, "Unsupported param type");
+    }
+
+#ifdef MARIADB_VERSION_ID
+    template<class... Params>
+    PreparedStatement* Connection::execute_direct(const std::string& sql, const Params&... params) {
+        std::unique_ptr<PreparedStatement> stmt(new PreparedStatement(*this));
+        if (sizeof...(Params)) stmt->prebind_params(sizeof...(Params));
+        PreparedStatement::idx_t col = 0;
+        (stmt->set(col++, params), ...);
+        stmt->execute_direct(sql);
+        return stmt.release();
+    }
+#endif
 }
 #endif
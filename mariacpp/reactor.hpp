@@ -0,0 +1,118 @@
+/****************************************************************************
+  Copyright (C) 2015 Karol Roslaniec <mariacpp@roslaniec.net>
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not see <http://www.gnu.org/licenses>
+  or write to the Free Software Foundation, Inc.,
+  51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+*****************************************************************************/
+#ifndef MARIACPP_REACTOR_HPP
+#define MARIACPP_REACTOR_HPP
+
+#include <mysql.h>
+#include <mariacpp/async.hpp>
+#include <mariacpp/bits/timer_wheel.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <unordered_map>
+#include <vector>
+
+#ifdef MARIADB_VERSION_ID
+
+namespace MariaCpp {
+
+    class Connection;
+
+    class PreparedStatement;
+
+    class ResultSet;
+
+    //  Event loop driving non-blocking operations of many connections
+    //  from a single thread (epoll on Linux, poll() elsewhere).
+    //
+    //  Operation is started as usual with one of *_start() methods,
+    //  then handed over to the reactor together with its *_cont() call.
+    //  The reactor waits for MYSQL_WAIT_READ/WRITE/EXCEPT readiness
+    //  (or MYSQL_WAIT_TIMEOUT, tracked in TimerWheel) of the connection socket, resumes
+    //  the operation, and calls completion once async_status() is 0.
+    //  Each connection may have at most one pending operation.
+    //  Sample usage:
+    //     conn.query_start(sql);
+    //     reactor.submit(conn, [&](int status) { conn.query_cont(status); },
+    //                    [](std::exception_ptr error) { ... });
+    //     reactor.run();
+    //  As AsyncScheduler it also resumes coroutines awaiting *_async():
+    //     MariaCpp::scoped_scheduler sched(reactor);
+    //     MariaCpp::spawn(handle_request(conn));
+    //     reactor.run();
+    //
+    //  Continuation is called with ready status (MYSQL_WAIT_*) to resume
+    //  operation, Completion once it's finished (error is null on success).
+    class Reactor : public AsyncScheduler {
+    public:
+        Reactor();
+
+        ~Reactor() override;
+
+        // If operation is already finished, done() is called immediately.
+        void submit(Connection& conn, Continuation cont, Completion done) override;
+
+        void submit(PreparedStatement& stmt, Continuation cont, Completion done);
+
+        void submit(ResultSet& res, Continuation cont, Completion done);
+
+        // Number of operations in progress
+        size_t pending() const { return _watches.size(); }
+
+        // Waits at most timeout_ms (-1 = no limit) for any event,
+        // and resumes all ready operations. Returns number of them.
+        size_t run_once(int timeout_ms = -1);
+
+        // Runs until there is no pending operation.
+        void run() { while (pending()) run_once(); }
+
+    private:
+        // Noncopyable
+        Reactor(const Reactor&);
+
+        void operator=(Reactor&);
+
+        // Timer is armed while operation waits for MYSQL_WAIT_TIMEOUT
+        struct Watch : TimerWheel::Timer {
+            Connection* conn;
+            Continuation cont;
+            Completion done;
+            int ready; // status collected by current run_once()
+        };
+
+        static uint64_t now_ms();
+
+        void ready(Watch& watch, int status);
+
+        void arm(Watch& watch);
+
+        void dispatch(Connection* conn);
+
+        void finish(Watch& watch, std::exception_ptr error);
+
+        std::unordered_map<Connection*, Watch> _watches;
+        std::vector<Connection*> _ready;
+        TimerWheel _timers;
+        int _epoll; // -1 if poll() is used
+    };
+}
+
+#endif /* MARIADB_VERSION_ID */
+#endif
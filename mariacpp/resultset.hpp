@@ -20,10 +20,19 @@
 #define MARIACPP_RESULTSET_HPP
 
 #include <mysql.h>
+#include <mariacpp/mariadb_error.hpp>
+#include <mariacpp/bits/column_index.hpp>
+#include <mariacpp/bits/row_range.hpp>
 #include <cstdint>
 #include <cassert>
+#include <cstddef>
+#include <span>
 #include <string>
+#include <string_view>
 #include <vector>
+#ifdef MARIADB_VERSION_ID
+#include <mariacpp/async.hpp>
+#endif
 
 namespace MariaCpp {
 
@@ -40,6 +49,8 @@ namespace MariaCpp {
 
         ~ResultSet() { if (_res) mysql_free_result(_res); }
 
+        Connection& connection() const { return _conn; }
+
         void data_seek(my_ulonglong offset) { return mysql_data_seek(_res, offset); }
 
         bool eof() const { return mysql_eof(_res); }
@@ -69,6 +80,19 @@ namespace MariaCpp {
 
         bool next() { return fetch_row(); }
 
+        // Input range of rows (see RowCursor), begin() fetches first row
+        RowCursor<ResultSet> begin() { return RowCursor<ResultSet>(this); }
+
+        std::default_sentinel_t end() const { return std::default_sentinel; }
+
+        // Rows decoded to tuples, column types are checked once:
+        //     for (auto [id, label, score] : res->rows<int64_t, std::string_view, std::optional<double>>())
+        template<class... Ts>
+        RowRange<ResultSet, Ts...> rows() { return RowRange<ResultSet, Ts...>(*this); }
+
+        // Non-throwing variant of next(), see Connection::try_query()
+        expected<bool> try_next() noexcept;
+
         unsigned int num_fields() const { return mysql_num_fields(_res); }
 
         my_ulonglong num_rows() const { return mysql_num_rows(_res); }
@@ -97,6 +121,16 @@ namespace MariaCpp {
 
         std::string getBinary(idx_t col) const { return getString(col); }
 
+        // Zero-copy access to row data, valid until next fetch_row()
+        // (stored result keeps it until free). NULL gives empty view.
+        std::string_view getStringView(idx_t col) const {
+            assert_col(col);
+            const char* data = _row[col];
+            return data ? std::string_view(data, length(col)) : std::string_view();
+        }
+
+        std::span<const std::byte> getBytes(idx_t col) const { return std::as_bytes(std::span(getStringView(col))); }
+
         int32_t getInt(idx_t col) const;
 
         uint32_t getUInt(idx_t col) const;
@@ -111,27 +145,55 @@ namespace MariaCpp {
 
 		double getDouble(idx_t col) const;
 
+        // Parses text of temporal column; NULL gives Time::none()
+        Time getDate(idx_t col) const; // same as getDateTime(col)
+
+        Time getDateTime(idx_t col) const;
+
+        Time getTime(idx_t col) const; // same as getDateTime(col)
+
+        Time getTimeStamp(idx_t col) const; // same as getDateTime(col)
+
+        // Builds column name index now; otherwise it's built
+        // on first access by name
         void fetchFieldNames();
 
-		bool isNull(const std::string& col) const;
+        // Resolves column name once, see ColumnRef
+        ColumnRef column(std::string_view name) const {
+            return ColumnRef{static_cast<idx_t>(getFieldIndexByName(name))};
+        }
+
+		bool isNull(std::string_view col) const;
+
+        std::string getString(std::string_view col) const;
+
+        std::string getBinary(std::string_view col) const { return getString(col); }
+
+        std::string_view getStringView(std::string_view col) const;
+
+        std::span<const std::byte> getBytes(std::string_view col) const { return std::as_bytes(std::span(getStringView(col))); }
+
+        int32_t getInt(std::string_view col) const;
 
-        std::string getString(const std::string& col) const;
+        uint32_t getUInt(std::string_view col) const;
 
-        std::string getBinary(const std::string& col) const { return getString(col); }
+        int64_t getInt64(std::string_view col) const;
 
-        int32_t getInt(const std::string& col) const;
+        uint64_t getUInt64(std::string_view col) const;
 
-        uint32_t getUInt(const std::string& col) const;
+        bool getBoolean(std::string_view col) const { return getInt(col); }
 
-        int64_t getInt64(const std::string& col) const;
+        float getFloat(std::string_view col) const;
 
-        uint64_t getUInt64(const std::string& col) const;
+        double getDouble(std::string_view col) const;
 
-        bool getBoolean(const std::string& col) const { return getInt(col); }
+        Time getDate(std::string_view col) const; // same as getDateTime(col)
 
-        float getFloat(const std::string& col) const;
+        Time getDateTime(std::string_view col) const;
 
-        double getDouble(const std::string& col) const;
+        Time getTime(std::string_view col) const; // same as getDateTime(col)
+
+        Time getTimeStamp(std::string_view col) const; // same as getDateTime(col)
 
 		idx_t length(idx_t col) const {
             assert_col(col);
@@ -154,6 +216,15 @@ namespace MariaCpp {
 
         bool next_cont(int status) { return fetch_row_cont(status); }
 
+        expected<bool> try_next_start() noexcept;
+
+        expected<bool> try_next_cont(int status) noexcept;
+
+        // Coroutine wrappers, see Connection::query_async()
+        Awaitable<void> free_result_async();
+
+        Awaitable<bool> next_async();
+
 #   endif /* MARIADB_VERSION_ID */
 
     private:
@@ -168,9 +239,12 @@ namespace MariaCpp {
         MYSQL_RES* _res;
         MYSQL_ROW _row; // _row == _res->current_row
         mutable unsigned long* _lengths; // == fetch_lengths()
-        std::vector<std::string> _col_names;
+        mutable std::vector<bool> _unsigned; // UNSIGNED_FLAG of columns
+        mutable ColumnIndex _columns;
+
+        int getFieldIndexByName(std::string_view name) const;
 
-        int getFieldIndexByName(const std::string& name) const;
+        bool is_unsigned(idx_t col) const;
     };
 
     void ResultSet::assert_col(idx_t col) const {
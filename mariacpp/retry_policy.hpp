@@ -0,0 +1,113 @@
+/****************************************************************************
+  Copyright (C) 2015 Karol Roslaniec <mariacpp@roslaniec.net>
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not see <http://www.gnu.org/licenses>
+  or write to the Free Software Foundation, Inc.,
+  51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+*****************************************************************************/
+#ifndef MARIACPP_RETRY_POLICY_HPP
+#define MARIACPP_RETRY_POLICY_HPP
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <set>
+
+namespace MariaCpp {
+
+    //  Decides whether failed Connection::query() or
+    //  PreparedStatement::execute() is executed again.
+    //  Retryable errors (by default ER_LOCK_DEADLOCK and ER_LOCK_WAIT_TIMEOUT)
+    //  are retried up to max_attempts() times in total, sleeping between
+    //  attempts with exponential backoff and full jitter:
+    //  random(0, min(max_delay, base_delay * 2^(attempt-1))).
+    //  Configure policy before it's used; retry() itself is thread-safe,
+    //  so one policy may be shared by many connections.
+    //  Sample usage:
+    //     static RetryPolicy policy;
+    //     policy.max_attempts(3).on_retry([](unsigned attempt, unsigned err, auto delay) { ... });
+    //     conn.set_retry_policy(policy);
+    //
+    class RetryPolicy {
+    public:
+        typedef std::chrono::milliseconds duration;
+
+        // Called before each retry with number of failed attempt.
+        // Must not throw: exception is caught and ignored by retry().
+        typedef std::function<void(unsigned attempt, unsigned err_no, duration delay)> Callback;
+
+        RetryPolicy();
+
+        // Policy used by connections without set_retry_policy()
+        static RetryPolicy& defaults();
+
+        // Total number of attempts, 1 disables retrying
+        RetryPolicy& max_attempts(unsigned attempts) {
+            _max_attempts = attempts ? attempts : 1;
+            return *this;
+        }
+
+        RetryPolicy& backoff(duration base_delay, duration max_delay) {
+            _base_delay = base_delay;
+            _max_delay = max_delay;
+            return *this;
+        }
+
+        RetryPolicy& retry_on(unsigned err_no) {
+            _retryable.insert(err_no);
+            return *this;
+        }
+
+        RetryPolicy& no_retry_on(unsigned err_no) {
+            _retryable.erase(err_no);
+            return *this;
+        }
+
+        RetryPolicy& on_retry(Callback callback) {
+            _on_retry = std::move(callback);
+            return *this;
+        }
+
+        unsigned max_attempts() const { return _max_attempts; }
+
+        bool retryable(unsigned err_no) const { return _retryable.count(err_no); }
+
+        // Called after attempt failed with err_no. If true is returned,
+        // the backoff delay (up to max_delay) has already elapsed and operation may be retried.
+        bool retry(unsigned attempt, unsigned err_no) noexcept;
+
+        // Number of retries done
+        uint64_t retries() const { return _retries.load(std::memory_order_relaxed); }
+
+        // Number of retryable errors thrown after last attempt
+        uint64_t exhausted() const { return _exhausted.load(std::memory_order_relaxed); }
+
+    private:
+        // Noncopyable
+        RetryPolicy(const RetryPolicy&);
+
+        void operator=(RetryPolicy&);
+
+        unsigned _max_attempts;
+        duration _base_delay;
+        duration _max_delay;
+        std::set<unsigned> _retryable;
+        Callback _on_retry;
+        std::atomic<uint64_t> _retries;
+        std::atomic<uint64_t> _exhausted;
+    };
+}
+
+#endif
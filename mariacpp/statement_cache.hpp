@@ -0,0 +1,130 @@
+/****************************************************************************
+  Copyright (C) 2015 Karol Roslaniec <mariacpp@roslaniec.net>
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not see <http://www.gnu.org/licenses>
+  or write to the Free Software Foundation, Inc.,
+  51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+*****************************************************************************/
+#ifndef MARIACPP_STATEMENT_CACHE_HPP
+#define MARIACPP_STATEMENT_CACHE_HPP
+
+#include <cstddef>
+#include <list>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+namespace MariaCpp {
+
+    class Connection;
+
+    class PreparedStatement;
+
+    //  LRU cache of prepared statements of single connection, keyed by SQL.
+    //  Enabled by Connection::set_statement_cache(capacity), used via
+    //  Connection::prepare_cached(sql).
+    //
+    //  Statement is handed out as Lease; on return it is reset (reset():
+    //  pending result, long data and params are freed, so params have
+    //  to be set by every lease) and it becomes idle again. If the same SQL
+    //  is leased twice at a time, the second lease gets a private
+    //  statement closed on return. Idle statements above capacity are
+    //  closed in LRU order. When the server refuses another statement
+    //  (max_prepared_stmt_count reached), idle statements are evicted
+    //  and capacity is lowered to what the server allows.
+    //  reset_connection(), change_user() and close() empty the cache.
+    //  Leases must be returned before connection is destroyed.
+    class StatementCache {
+    public:
+        class Lease;
+
+        StatementCache(Connection& conn, size_t capacity);
+
+        ~StatementCache();
+
+        Lease acquire(const std::string& sql);
+
+        // Closes idle statements, leased ones are closed on return
+        void clear();
+
+        size_t capacity() const { return _capacity; }
+
+        // Closes idle statements above capacity, leased ones on return
+        void set_capacity(size_t capacity);
+
+        size_t size() const { return _lru.size(); }
+
+    private:
+        // Noncopyable
+        StatementCache(const StatementCache&);
+
+        void operator=(StatementCache&);
+
+        struct Entry {
+            std::string sql;
+            std::unique_ptr<PreparedStatement> stmt;
+            bool leased;
+            bool stale; // leased during clear(), closed on return
+        };
+
+        typedef std::list<Entry>::iterator iterator;
+
+        PreparedStatement* prepare(const std::string& sql);
+
+        bool evict_one();
+
+        void release(Entry* entry, PreparedStatement* stmt) noexcept;
+
+        Connection& _conn;
+        size_t _capacity;
+        std::list<Entry> _lru; // most recently used first
+        std::list<Entry> _stale;
+        std::unordered_map<std::string_view, iterator> _index; // views of Entry::sql
+    };
+
+    // Statement borrowed from StatementCache, returned on destruction
+    class StatementCache::Lease {
+    public:
+        Lease() : _cache(), _entry(), _stmt() {}
+
+        Lease(Lease&& other) noexcept;
+
+        Lease& operator=(Lease&& other) noexcept;
+
+        ~Lease() { release(); }
+
+        PreparedStatement* get() const { return _stmt; }
+
+        PreparedStatement& operator*() const { return *_stmt; }
+
+        PreparedStatement* operator->() const { return _stmt; }
+
+        explicit operator bool() const { return _stmt; }
+
+        void release() noexcept;
+
+    private:
+        friend class StatementCache;
+
+        Lease(StatementCache* cache, Entry* entry, PreparedStatement* stmt)
+                : _cache(cache), _entry(entry), _stmt(stmt) {}
+
+        StatementCache* _cache;
+        Entry* _entry; // null if statement is private to this lease
+        PreparedStatement* _stmt;
+    };
+}
+
+#endif
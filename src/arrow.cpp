@@ -0,0 +1,188 @@
+/****************************************************************************
+  Copyright (C) 2015 Karol Roslaniec <mariacpp@roslaniec.net>
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not see <http://www.gnu.org/licenses>
+  or write to the Free Software Foundation, Inc.,
+  51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+*****************************************************************************/
+#include <mariacpp/arrow.hpp>
+#include <mariacpp/prepared_stmt.hpp>
+#include <mariacpp/resultset.hpp>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace MariaCpp {
+
+    namespace {
+        // Non-null pointer for empty buffers
+        const int64_t EMPTY_BUFFER[1] = {0};
+
+        const void* buffer(const void* data) { return data ? data : EMPTY_BUFFER; }
+
+        // Child of exported struct owns its data, so it may be moved out
+        // by consumer and released independently of parent.
+        struct ChildSchema {
+            std::string name;
+        };
+
+        struct ChildArray {
+            ColumnarResult::Column column;
+            const void* buffers[3];
+        };
+
+        struct ParentSchema {
+            std::vector<ArrowSchema> children;
+            std::vector<ArrowSchema*> pointers;
+        };
+
+        struct ParentArray {
+            std::vector<ArrowArray> children;
+            std::vector<ArrowArray*> pointers;
+            const void* buffers[1];
+        };
+
+        void release_child_schema(ArrowSchema* schema) {
+            delete static_cast<ChildSchema*>(schema->private_data);
+            schema->release = nullptr;
+        }
+
+        void release_child_array(ArrowArray* array) {
+            delete static_cast<ChildArray*>(array->private_data);
+            array->release = nullptr;
+        }
+
+        void release_schema(ArrowSchema* schema) {
+            ParentSchema* parent = static_cast<ParentSchema*>(schema->private_data);
+            for (ArrowSchema& child: parent->children)
+                if (child.release) child.release(&child);
+            delete parent;
+            schema->release = nullptr;
+        }
+
+        void release_array(ArrowArray* array) {
+            ParentArray* parent = static_cast<ParentArray*>(array->private_data);
+            for (ArrowArray& child: parent->children)
+                if (child.release) child.release(&child);
+            delete parent;
+            array->release = nullptr;
+        }
+
+        const char* format_of(const ColumnarResult::Column& column) {
+            switch (column.type) {
+                case ColumnarResult::COLUMN_INT64: return "l";
+                case ColumnarResult::COLUMN_UINT64: return "L";
+                case ColumnarResult::COLUMN_DOUBLE: return "g";
+                case ColumnarResult::COLUMN_STRING: break;
+            }
+            return column.binary ? "Z" : "U";
+        }
+
+        const void* values_of(const ColumnarResult::Column& column) {
+            switch (column.type) {
+                case ColumnarResult::COLUMN_INT64: return column.int64s.data();
+                case ColumnarResult::COLUMN_UINT64: return column.uint64s.data();
+                case ColumnarResult::COLUMN_DOUBLE: return column.doubles.data();
+                case ColumnarResult::COLUMN_STRING: break;
+            }
+            return column.offsets.data();
+        }
+    }
+
+    void export_arrow(ColumnarResult&& result, ArrowSchema* schema, ArrowArray* array) {
+        const size_t count = result._columns.size();
+        const int64_t rows = static_cast<int64_t>(result._rows);
+        std::unique_ptr<ParentSchema> parent_schema(new ParentSchema());
+        std::unique_ptr<ParentArray> parent_array(new ParentArray());
+        std::vector<std::unique_ptr<ChildSchema>> child_schemas(count);
+        std::vector<std::unique_ptr<ChildArray>> child_arrays(count);
+        parent_schema->children.resize(count);
+        parent_schema->pointers.resize(count);
+        parent_array->children.resize(count);
+        parent_array->pointers.resize(count);
+        for (size_t col = 0; col < count; ++col) {
+            child_schemas[col].reset(new ChildSchema());
+            child_arrays[col].reset(new ChildArray());
+        }
+
+        // Nothing throws below, ownership goes to release() callbacks
+        for (size_t col = 0; col < count; ++col) {
+            ColumnarResult::Column& column = result._columns[col];
+            ChildSchema* cs = child_schemas[col].release();
+            cs->name = std::move(column.name);
+            ArrowSchema& s = parent_schema->children[col];
+            s.format = format_of(column);
+            s.name = cs->name.c_str();
+            s.metadata = nullptr;
+            s.flags = ARROW_FLAG_NULLABLE;
+            s.n_children = 0;
+            s.children = nullptr;
+            s.dictionary = nullptr;
+            s.release = release_child_schema;
+            s.private_data = cs;
+            parent_schema->pointers[col] = &s;
+
+            ChildArray* ca = child_arrays[col].release();
+            ca->column = std::move(column);
+            const ColumnarResult::Column& moved = ca->column;
+            ArrowArray& a = parent_array->children[col];
+            a.length = rows;
+            a.null_count = static_cast<int64_t>(moved.null_count);
+            a.offset = 0;
+            a.n_buffers = ColumnarResult::COLUMN_STRING == moved.type ? 3 : 2;
+            a.n_children = 0;
+            ca->buffers[0] = moved.null_count ? moved.validity.data() : nullptr;
+            ca->buffers[1] = buffer(values_of(moved));
+            ca->buffers[2] = buffer(moved.data.data());
+            a.buffers = ca->buffers;
+            a.children = nullptr;
+            a.dictionary = nullptr;
+            a.release = release_child_array;
+            a.private_data = ca;
+            parent_array->pointers[col] = &a;
+        }
+
+        schema->format = "+s";
+        schema->name = "";
+        schema->metadata = nullptr;
+        schema->flags = 0;
+        schema->n_children = static_cast<int64_t>(count);
+        schema->children = parent_schema->pointers.data();
+        schema->dictionary = nullptr;
+        schema->release = release_schema;
+        schema->private_data = parent_schema.release();
+
+        parent_array->buffers[0] = nullptr;
+        array->length = rows;
+        array->null_count = 0;
+        array->offset = 0;
+        array->n_buffers = 1;
+        array->n_children = static_cast<int64_t>(count);
+        array->buffers = parent_array->buffers;
+        array->children = parent_array->pointers.data();
+        array->dictionary = nullptr;
+        array->release = release_array;
+        array->private_data = parent_array.release();
+        result._rows = 0;
+    }
+
+    void export_arrow(ResultSet& res, ArrowSchema* schema, ArrowArray* array, size_t max_rows) {
+        export_arrow(ColumnarResult(res, max_rows), schema, array);
+    }
+
+    void export_arrow(PreparedStatement& stmt, ArrowSchema* schema, ArrowArray* array, size_t max_rows) {
+        export_arrow(ColumnarResult(stmt, max_rows), schema, array);
+    }
+}
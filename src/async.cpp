@@ -0,0 +1,85 @@
+/****************************************************************************
+  Copyright (C) 2015 Karol Roslaniec <mariacpp@roslaniec.net>
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not see <http://www.gnu.org/licenses>
+  or write to the Free Software Foundation, Inc.,
+  51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+*****************************************************************************/
+#include <mariacpp/async.hpp>
+#include <mariacpp/connection.hpp>
+#ifdef MARIADB_VERSION_ID
+
+namespace MariaCpp {
+
+    static thread_local AsyncScheduler* current_scheduler = nullptr;
+
+    AsyncScheduler* AsyncScheduler::current() {
+        return current_scheduler;
+    }
+
+    AsyncScheduler* AsyncScheduler::current(AsyncScheduler* scheduler) {
+        return std::exchange(current_scheduler, scheduler);
+    }
+
+    AsyncOpBase::AsyncOpBase(Connection& conn)
+            : _conn(conn), _scheduler(AsyncScheduler::current()) {}
+
+    bool AsyncOpBase::finished() {
+        if (!_scheduler)
+            while (_conn.async_status()) resume(_conn.async_wait());
+        return !_conn.async_status();
+    }
+
+    void AsyncOpBase::await_suspend(std::coroutine_handle<> handle) {
+        _scheduler->submit(_conn, [this](int status) { resume(status); },
+                           [this, handle](std::exception_ptr error) {
+            _error = error;
+            handle.resume();
+        });
+    }
+
+    namespace {
+        // Coroutine owning itself, destroyed when finished
+        struct Detached {
+            struct promise_type {
+                Detached get_return_object() { return Detached(); }
+
+                std::suspend_never initial_suspend() noexcept { return {}; }
+
+                std::suspend_never final_suspend() noexcept { return {}; }
+
+                void return_void() {}
+
+                void unhandled_exception() { std::terminate(); }
+            };
+        };
+
+        Detached run_detached(Task<void> task, AsyncScheduler::Completion done) {
+            std::exception_ptr error;
+            try {
+                co_await task;
+            } catch (...) {
+                error = std::current_exception();
+            }
+            if (done) done(error);
+            else if (error) std::rethrow_exception(error);
+        }
+    }
+
+    void spawn(Task<void> task, AsyncScheduler::Completion done) {
+        run_detached(std::move(task), std::move(done));
+    }
+}
+
+#endif /* MARIADB_VERSION_ID */
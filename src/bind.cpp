@@ -17,6 +17,7 @@
   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
 *****************************************************************************/
 #include <mariacpp/bits/bind.hpp>
+#include <mariacpp/bits/parse.hpp>
 #include <mariacpp/mariadb_error.hpp>
 #include <mariacpp/time.hpp>
 #include <errmsg.h> // MariaDB
@@ -25,36 +26,7 @@
 #include <cstring>
 #include <iomanip>
 #include <sstream>
-#include <charconv>
-
-template<typename T>
-constexpr T from_chars(const char* first, const char* last) {
-#if __cpp_lib_to_chars >= 201611L
-    T out;
-    std::from_chars(first, last, out);
-    return out;
-#else
-    if constexpr (std::is_same<T, int32_t>::value) {
-        return strtol(std::string(first, last - first).c_str(), nullptr, 10);
-    }
-    else if constexpr (std::is_same<T, uint32_t>::value) {
-        return strtoul(std::string(first, last - first).c_str(), nullptr, 10);
-    }
-    else if constexpr (std::is_same<T, int64_t>::value) {
-        return strtoll(std::string(first, last - first).c_str(), nullptr, 10);
-    }
-    else if constexpr (std::is_same<T, uint64_t>::value) {
-        return strtoull(std::string(first, last - first).c_str(), nullptr, 10);
-    }
-    else if constexpr (std::is_same<T, float>::value) {
-        return stof(std::string(first, last - first), nullptr);
-    }
-    else if constexpr (std::is_same<T, double>::value) {
-        return stod(std::string(first, last - first), nullptr);
-    }
-    return {};
-#endif
-}
+#include <utility>
 
 namespace MariaCpp {
 
@@ -89,7 +61,8 @@ namespace MariaCpp {
         heap = false;
     }
 
-    Bind::Bind() : _buffer(), _length(), _type(MYSQL_TYPE_NULL), _null(true), _unsigned(false), _error(false), _heap(false) {
+    Bind::Bind() : _buffer(), _length(), _type(MYSQL_TYPE_NULL), _null(true), _unsigned(false), _error(false), _heap(false), _viewed(false),
+                   _array(), _lengths(), _indicators() {
     }
 
     Bind::~Bind() {
@@ -102,6 +75,14 @@ namespace MariaCpp {
 
     Bind::operator MYSQL_BIND() {
         MYSQL_BIND res = MYSQL_BIND();
+        if (_array) {
+            res.buffer = const_cast<void*>(_array);
+            res.length = const_cast<unsigned long*>(_lengths);
+            res.u.indicator = const_cast<char*>(_indicators);
+            res.buffer_type = _type;
+            res.is_unsigned = _unsigned;
+            return res;
+        }
         res.is_null = &_null;
         res.length = &_length;
         res.error = &_error;
@@ -180,10 +161,11 @@ namespace MariaCpp {
 
     template<typename T>
     bool Bind::setNumeric(T value, const enum_field_types type, const bool is_uns) {
-        void* const old = _buffer.data(_heap);
+        void* old = _buffer.data(_heap);
         void* data = _buffer.alloc(_heap, sizeof(T));
         *reinterpret_cast<T*>(data) = value;
         _null = false;
+        if (std::exchange(_array, nullptr)) old = nullptr;
         if (type == _type && is_uns == static_cast<const bool>(_unsigned) && old == data) return false;
         _type = type;
         _unsigned = is_uns;
@@ -192,11 +174,12 @@ namespace MariaCpp {
 
     bool Bind::setBuffer(const char* str, size_t len, enum_field_types type) {
         _null = !str;
-        void* const old = _buffer.data(_heap);
+        void* old = _buffer.data(_heap);
         void* data = _buffer.alloc(_heap, len);
         assert(str || !len);
         memcpy(data, str, len);
         _length = static_cast<unsigned long>(len);
+        if (std::exchange(_array, nullptr)) old = nullptr;
         if (type == _type && old == data) return false;
         _type = type;
         return true;
@@ -209,7 +192,18 @@ namespace MariaCpp {
 
     bool Bind::setNull() {
         _null = true;
-        return false;
+        return std::exchange(_array, nullptr);
+    }
+
+    bool Bind::setArray(enum_field_types type, bool is_uns, const void* values,
+                        const unsigned long* lengths, const char* indicators) {
+        if (!values) throw InvalidArgumentException("Bind array without values");
+        _array = values;
+        _lengths = lengths;
+        _indicators = indicators;
+        _type = type;
+        _unsigned = is_uns;
+        return true;
     }
 
     bool Bind::setTinyInt(int8_t value) {
@@ -314,6 +308,45 @@ namespace MariaCpp {
         return static_cast<uint32_t>(getUInt64());
     }
 
+    bool Bind::isStringType(enum_field_types type) {
+        switch (type) {
+            case MYSQL_TYPE_DECIMAL:
+            case MYSQL_TYPE_NEWDECIMAL:
+            case MYSQL_TYPE_TINY_BLOB:
+            case MYSQL_TYPE_MEDIUM_BLOB:
+            case MYSQL_TYPE_LONG_BLOB:
+            case MYSQL_TYPE_BLOB:
+            case MYSQL_TYPE_VAR_STRING:
+            case MYSQL_TYPE_STRING:
+            case MYSQL_TYPE_VARCHAR:
+            case MYSQL_TYPE_BIT:
+            case MYSQL_TYPE_ENUM:
+            case MYSQL_TYPE_SET:
+            case MYSQL_TYPE_NEWDATE:
+            case MYSQL_TYPE_GEOMETRY:
+                return true;
+            default:
+                return false;
+        }
+    }
+
+    std::string_view Bind::getStringView() const {
+        const void* data = _buffer.data(_heap);
+        if (_null || !data) return std::string_view();
+        if (!isStringType(_type)) throw InvalidArgumentException("Column is not a string, use getString()");
+        _viewed = true;
+        return std::string_view(reinterpret_cast<const char*>(data), data_length());
+    }
+
+    void Bind::expire_views() {
+#   ifndef NDEBUG
+        if (!_viewed) return;
+        _viewed = false;
+        // Dangling string_view shows garbage instead of plausible data
+        std::memset(_buffer.data(_heap), 0xDD, data_length());
+#   endif
+    }
+
     std::string Bind::getString() const {
         const void* data = _buffer.data(_heap);
         if (_null || !data) return std::string();
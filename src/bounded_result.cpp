@@ -0,0 +1,284 @@
+/****************************************************************************
+  Copyright (C) 2015 Karol Roslaniec <mariacpp@roslaniec.net>
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not see <http://www.gnu.org/licenses>
+  or write to the Free Software Foundation, Inc.,
+  51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+*****************************************************************************/
+#include <mariacpp/bounded_result.hpp>
+#include <mariacpp/mariadb_error.hpp>
+#include <mariacpp/resultset.hpp>
+#include <mariacpp/bits/parse.hpp>
+#include <algorithm>
+#include <cerrno>
+#include <cstdlib>
+#ifdef WIN32
+#ifndef NOMINMAX
+#define NOMINMAX // std::min/max below
+#endif
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+namespace MariaCpp {
+
+    //  Append-only temporary file, deleted once closed; writes are
+    //  buffered, the whole file is mapped read-only after last write.
+    class BoundedResult::File {
+    public:
+        explicit File(const char* dir);
+
+        ~File();
+
+        void write(const char* data, size_t size) {
+            if (BUFFER_SIZE < _buffer.size() + size) flush();
+            if (BUFFER_SIZE < size) return write_all(data, size);
+            _buffer.insert(_buffer.end(), data, data + size);
+        }
+
+        const char* map();
+
+    private:
+        static constexpr size_t BUFFER_SIZE = 1 << 16;
+
+        // Noncopyable
+        File(const File&);
+
+        void operator=(File&);
+
+        void flush() {
+            write_all(_buffer.data(), _buffer.size());
+            _buffer.clear();
+        }
+
+        void write_all(const char* data, size_t size);
+
+        std::vector<char> _buffer;
+        uint64_t _size;
+        void* _map;
+#   ifdef WIN32
+        HANDLE _file;
+        HANDLE _mapping;
+#   else
+        int _fd;
+#   endif
+    };
+
+#ifdef WIN32
+
+    BoundedResult::File::File(const char* dir) : _size(), _map(), _mapping() {
+        char tmp[MAX_PATH + 1];
+        if (!dir) {
+            if (!GetTempPathA(sizeof(tmp), tmp)) throw mariadb_error("GetTempPath() failed");
+            dir = tmp;
+        }
+        char path[MAX_PATH + 1];
+        if (!GetTempFileNameA(dir, "mcp", 0, path)) throw mariadb_error("GetTempFileName() failed");
+        _file = CreateFileA(path, GENERIC_READ | GENERIC_WRITE, 0, nullptr, CREATE_ALWAYS,
+                            FILE_ATTRIBUTE_TEMPORARY | FILE_FLAG_DELETE_ON_CLOSE, nullptr);
+        if (INVALID_HANDLE_VALUE == _file) {
+            DeleteFileA(path);
+            throw mariadb_error("CreateFile() of temporary file failed");
+        }
+    }
+
+    BoundedResult::File::~File() {
+        if (_map) UnmapViewOfFile(_map);
+        if (_mapping) CloseHandle(_mapping);
+        CloseHandle(_file);
+    }
+
+    void BoundedResult::File::write_all(const char* data, size_t size) {
+        while (size) {
+            DWORD written = 0;
+            const DWORD chunk = static_cast<DWORD>(std::min<size_t>(size, 1 << 30));
+            if (!WriteFile(_file, data, chunk, &written, nullptr))
+                throw mariadb_error("WriteFile() of temporary file failed");
+            data += written;
+            size -= written;
+            _size += written;
+        }
+    }
+
+    const char* BoundedResult::File::map() {
+        flush();
+        _mapping = CreateFileMappingA(_file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        if (!_mapping) throw mariadb_error("CreateFileMapping() failed");
+        _map = MapViewOfFile(_mapping, FILE_MAP_READ, 0, 0, 0);
+        if (!_map) throw mariadb_error("MapViewOfFile() failed");
+        return static_cast<const char*>(_map);
+    }
+
+#else
+
+    BoundedResult::File::File(const char* dir) : _size(), _map() {
+        if (!dir) dir = std::getenv("TMPDIR");
+        if (!dir || !*dir) dir = "/tmp";
+        std::string path = std::string(dir) + "/mariacpp-XXXXXX";
+        _fd = mkstemp(&path[0]);
+        if (_fd < 0) throw mariadb_error("mkstemp() failed");
+        // Space is freed as soon as file is closed, even on crash
+        unlink(path.c_str());
+    }
+
+    BoundedResult::File::~File() {
+        if (_map) munmap(_map, _size);
+        close(_fd);
+    }
+
+    void BoundedResult::File::write_all(const char* data, size_t size) {
+        while (size) {
+            const ssize_t written = ::write(_fd, data, size);
+            if (written < 0) {
+                if (errno == EINTR) continue;
+                throw mariadb_error("write() of temporary file failed");
+            }
+            data += written;
+            size -= written;
+            _size += written;
+        }
+    }
+
+    const char* BoundedResult::File::map() {
+        flush();
+        if (static_cast<uint64_t>(static_cast<size_t>(_size)) != _size)
+            throw mariadb_error("temporary file too big to map");
+        void* map = mmap(nullptr, _size, PROT_READ, MAP_PRIVATE, _fd, 0);
+        if (MAP_FAILED == map) throw mariadb_error("mmap() of temporary file failed");
+        _map = map;
+        return static_cast<const char*>(_map);
+    }
+
+#endif /* WIN32 */
+
+    namespace {
+        void put_varint(std::vector<char>& out, uint64_t value) {
+            for (; 0x80 <= value; value >>= 7)
+                out.push_back(static_cast<char>(value | 0x80));
+            out.push_back(static_cast<char>(value));
+        }
+
+        uint64_t get_varint(const char*& in) {
+            uint64_t value = 0;
+            for (unsigned shift = 0;; shift += 7) {
+                const uint8_t byte = static_cast<uint8_t>(*in++);
+                value |= static_cast<uint64_t>(byte & 0x7f) << shift;
+                if (!(byte & 0x80)) return value;
+            }
+        }
+    }
+
+    BoundedResult::BoundedResult(ResultSet& res, size_t memory_budget, const char* tmpdir)
+            : _fields(res.num_fields()), _memory_budget(memory_budget), _map(), _next(),
+              _cells(_fields), _lengths(_fields) {
+        const MYSQL_FIELD* fields = res.fetch_fields();
+        _unsigned.resize(_fields);
+        for (idx_t col = 0; col < _fields; ++col)
+            _unsigned[col] = fields[col].flags & UNSIGNED_FLAG;
+        _columns.assign(fields, _fields);
+
+        _offsets.push_back(0);
+        while (const MYSQL_ROW row = res.fetch_row()) {
+            append(row, res.fetch_lengths());
+            // Row which doesn't fit goes to file, and so do all following
+            if (!_file && _encoded.size() <= _memory_budget - _memory.size()) {
+                if (_memory.capacity() < _memory.size() + _encoded.size())
+                    _memory.reserve(std::min(_memory_budget, std::max(2 * _memory.capacity(),
+                                                                      _memory.size() + _encoded.size())));
+                _memory.insert(_memory.end(), _encoded.begin(), _encoded.end());
+            } else {
+                if (!_file) _file.reset(new File(tmpdir));
+                _file->write(_encoded.data(), _encoded.size());
+            }
+            _offsets.push_back(_offsets.back() + _encoded.size());
+        }
+        if (_file) _map = _file->map();
+        std::vector<char>().swap(_encoded);
+    }
+
+    BoundedResult::~BoundedResult() {}
+
+    void BoundedResult::append(const MYSQL_ROW row, const unsigned long* lengths) {
+        _encoded.clear();
+        for (idx_t col = 0; col < _fields; ++col) {
+            if (!row[col]) {
+                put_varint(_encoded, 0);
+                continue;
+            }
+            put_varint(_encoded, static_cast<uint64_t>(lengths[col]) + 1);
+            _encoded.insert(_encoded.end(), row[col], row[col] + lengths[col]);
+        }
+    }
+
+    const char* BoundedResult::row_data(my_ulonglong row) const {
+        const uint64_t offset = _offsets[row];
+        if (offset < _memory.size()) return _memory.data() + offset;
+        return _map + (offset - _memory.size());
+    }
+
+    bool BoundedResult::next() {
+        if (num_rows() <= _next) return false;
+        const char* data = row_data(_next++);
+        for (idx_t col = 0; col < _fields; ++col) {
+            const uint64_t length = get_varint(data);
+            if (!length) {
+                _cells[col] = nullptr;
+                _lengths[col] = 0;
+                continue;
+            }
+            _cells[col] = data;
+            _lengths[col] = static_cast<unsigned long>(length - 1);
+            data += length - 1;
+        }
+        return true;
+    }
+
+    ColumnRef BoundedResult::column(std::string_view name) const {
+        const int col = _columns.find(name);
+        if (col < 0) throw mariadb_error("unknown column name \"" + std::string(name) + "\".");
+        return ColumnRef{static_cast<idx_t>(col)};
+    }
+
+    int32_t BoundedResult::getInt(idx_t col) const {
+        const std::string_view data = getStringView(col);
+        return from_chars<int32_t>(data.data(), data.data() + data.size(), _unsigned[col]);
+    }
+
+    uint32_t BoundedResult::getUInt(idx_t col) const {
+        const std::string_view data = getStringView(col);
+        return from_chars<uint32_t>(data.data(), data.data() + data.size(), _unsigned[col]);
+    }
+
+    int64_t BoundedResult::getInt64(idx_t col) const {
+        const std::string_view data = getStringView(col);
+        return from_chars<int64_t>(data.data(), data.data() + data.size(), _unsigned[col]);
+    }
+
+    uint64_t BoundedResult::getUInt64(idx_t col) const {
+        const std::string_view data = getStringView(col);
+        return from_chars<uint64_t>(data.data(), data.data() + data.size(), _unsigned[col]);
+    }
+
+    float BoundedResult::getFloat(idx_t col) const {
+        const std::string_view data = getStringView(col);
+        return from_chars<float>(data.data(), data.data() + data.size());
+    }
+
+    double BoundedResult::getDouble(idx_t col) const {
+        const std::string_view data = getStringView(col);
+        return from_chars<double>(data.data(), data.data() + data.size());
+    }
+}
@@ -0,0 +1,71 @@
+/****************************************************************************
+  Copyright (C) 2015 Karol Roslaniec <mariacpp@roslaniec.net>
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not see <http://www.gnu.org/licenses>
+  or write to the Free Software Foundation, Inc.,
+  51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+*****************************************************************************/
+#include <mariacpp/bits/column_index.hpp>
+
+namespace MariaCpp {
+
+    static inline unsigned char lower(unsigned char c) {
+        return 'A' <= c && c <= 'Z' ? c | 0x20 : c;
+    }
+
+    // FNV-1a of lower-cased name
+    size_t ColumnIndex::hash(std::string_view name) {
+        size_t h = 14695981039346656037ull;
+        for (unsigned char c: name) h = (h ^ lower(c)) * 1099511628211ull;
+        return h;
+    }
+
+    bool ColumnIndex::equals(std::string_view a, std::string_view b) {
+        if (a.size() != b.size()) return false;
+        for (size_t i = 0; i < a.size(); ++i)
+            if (lower(a[i]) != lower(b[i])) return false;
+        return true;
+    }
+
+    void ColumnIndex::assign(const MYSQL_FIELD* fields, unsigned int count) {
+        clear();
+        _names.reserve(count);
+        size_t size = 4;
+        while (size < 2 * count) size *= 2; // load factor <= 0.5
+        _slots.assign(size, 0);
+        _mask = size - 1;
+        for (unsigned int i = 0; i < count; ++i) {
+            _names.emplace_back(fields[i].name, fields[i].name_length);
+            if (0 <= find(_names.back())) continue; // duplicate
+            size_t slot = hash(_names.back()) & _mask;
+            while (_slots[slot]) slot = (slot + 1) & _mask;
+            _slots[slot] = i + 1;
+        }
+    }
+
+    void ColumnIndex::clear() {
+        _names.clear();
+        _slots.clear();
+        _mask = 0;
+    }
+
+    int ColumnIndex::find(std::string_view name) const {
+        if (_slots.empty()) return -1;
+        for (size_t slot = hash(name) & _mask; _slots[slot]; slot = (slot + 1) & _mask) {
+            const unsigned int col = _slots[slot] - 1;
+            if (equals(_names[col], name)) return static_cast<int>(col);
+        }
+        return -1;
+    }
+}
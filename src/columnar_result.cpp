@@ -0,0 +1,193 @@
+/****************************************************************************
+  Copyright (C) 2015 Karol Roslaniec <mariacpp@roslaniec.net>
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not see <http://www.gnu.org/licenses>
+  or write to the Free Software Foundation, Inc.,
+  51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+*****************************************************************************/
+#include <mariacpp/columnar_result.hpp>
+#include <mariacpp/mariadb_error.hpp>
+#include <mariacpp/prepared_stmt.hpp>
+#include <mariacpp/resultset.hpp>
+#include <mariacpp/bits/bind.hpp>
+#include <mariacpp/bits/decode.hpp>
+#include <cstring>
+#include <memory>
+
+namespace MariaCpp {
+
+    static ColumnarResult::column_type column_type_of(const MYSQL_FIELD& field) {
+        switch (field.type) {
+            case MYSQL_TYPE_TINY:
+            case MYSQL_TYPE_SHORT:
+            case MYSQL_TYPE_INT24:
+            case MYSQL_TYPE_LONG:
+            case MYSQL_TYPE_LONGLONG:
+                return field.flags & UNSIGNED_FLAG ? ColumnarResult::COLUMN_UINT64 : ColumnarResult::COLUMN_INT64;
+            case MYSQL_TYPE_YEAR:
+                return ColumnarResult::COLUMN_INT64;
+            case MYSQL_TYPE_FLOAT:
+            case MYSQL_TYPE_DOUBLE:
+                return ColumnarResult::COLUMN_DOUBLE;
+            default:
+                return ColumnarResult::COLUMN_STRING;
+        }
+    }
+
+    // charsetnr is 63 (binary) for numeric and temporal columns as well
+    static bool is_binary(const MYSQL_FIELD& field) {
+        switch (field.type) {
+            case MYSQL_TYPE_DECIMAL:
+            case MYSQL_TYPE_NEWDECIMAL:
+            case MYSQL_TYPE_NEWDATE:
+                return false;
+            default:
+                return 63 == field.charsetnr && Bind::isStringType(field.type);
+        }
+    }
+
+    void ColumnarResult::init(const MYSQL_FIELD* fields, idx_t count) {
+        _columns.resize(count);
+        for (idx_t col = 0; col < count; ++col) {
+            Column& column = _columns[col];
+            column.name.assign(fields[col].name, fields[col].name_length);
+            column.type = column_type_of(fields[col]);
+            column.field_type = fields[col].type;
+            column.binary = is_binary(fields[col]);
+            column.null_count = 0;
+            if (COLUMN_STRING == column.type) column.offsets.push_back(0);
+        }
+        _index.assign(fields, count);
+    }
+
+    ColumnarResult::ColumnarResult(ResultSet& res, size_t max_rows) : _rows() {
+        const idx_t count = res.num_fields();
+        init(res.fetch_fields(), count);
+
+        // Streamed (use_result) row is overwritten by next fetch_row()
+        const size_t batch = res.eof() ? BATCH_ROWS : 1;
+        std::vector<const char*> cells;
+        std::vector<unsigned long> lengths;
+        cells.reserve(batch * count);
+        lengths.reserve(batch * count);
+        while (_rows < max_rows) {
+            size_t rows = 0;
+            cells.clear();
+            lengths.clear();
+            while (rows < batch && _rows + rows < max_rows) {
+                MYSQL_ROW row = res.fetch_row();
+                if (!row) break;
+                const unsigned long* len = res.fetch_lengths();
+                cells.insert(cells.end(), row, row + count);
+                lengths.insert(lengths.end(), len, len + count);
+                ++rows;
+            }
+            if (!rows) break;
+            for (idx_t col = 0; col < count; ++col)
+                append(_columns[col], cells.data() + col, lengths.data() + col, count, rows);
+            _rows += rows;
+        }
+    }
+
+    ColumnarResult::ColumnarResult(PreparedStatement& stmt, size_t max_rows) : _rows() {
+        std::unique_ptr<ResultSet> meta(stmt.result_metadata());
+        if (!meta) return;
+        const idx_t count = meta->num_fields();
+        init(meta->fetch_fields(), count);
+        for (; _rows < max_rows && stmt.fetch(); ++_rows)
+            for (idx_t col = 0; col < count; ++col)
+                append(_columns[col], stmt, col);
+    }
+
+    void ColumnarResult::append(Column& column, const PreparedStatement& stmt, idx_t col) {
+        const size_t row = _rows;
+        if (row % 8 == 0) column.validity.push_back(0);
+        const bool null = stmt.isNull(col);
+        if (!null) column.validity[row / 8] |= static_cast<uint8_t>(1u << (row % 8));
+        else ++column.null_count;
+        switch (column.type) {
+            case COLUMN_INT64:
+                column.int64s.push_back(null ? 0 : stmt.getInt64(col));
+                break;
+            case COLUMN_UINT64:
+                column.uint64s.push_back(null ? 0 : stmt.getUInt64(col));
+                break;
+            case COLUMN_DOUBLE:
+                column.doubles.push_back(null ? 0 : stmt.getDouble(col));
+                break;
+            case COLUMN_STRING: {
+                if (!null && Bind::isStringType(column.field_type)) {
+                    const std::string_view value = stmt.getStringView(col);
+                    column.data.insert(column.data.end(), value.begin(), value.end());
+                } else if (!null) {
+                    const std::string value = stmt.getString(col);
+                    column.data.insert(column.data.end(), value.begin(), value.end());
+                }
+                column.offsets.push_back(static_cast<int64_t>(column.data.size()));
+                break;
+            }
+        }
+    }
+
+    // Decodes count cells (every stride-th one) into column
+    void ColumnarResult::append(Column& column, const char* const* cells, const unsigned long* lengths,
+                                size_t stride, size_t count) {
+        const size_t first = _rows;
+        column.validity.resize((first + count + 7) / 8);
+        for (size_t i = 0; i < count; ++i) {
+            const size_t row = first + i;
+            if (cells[i * stride]) column.validity[row / 8] |= static_cast<uint8_t>(1u << (row % 8));
+            else ++column.null_count;
+        }
+        switch (column.type) {
+            case COLUMN_INT64: {
+                column.int64s.resize(first + count);
+                decode_int64(cells, lengths, stride, count, column.int64s.data() + first);
+                break;
+            }
+            case COLUMN_UINT64: {
+                column.uint64s.resize(first + count);
+                decode_uint64(cells, lengths, stride, count, column.uint64s.data() + first);
+                break;
+            }
+            case COLUMN_DOUBLE: {
+                column.doubles.resize(first + count);
+                decode_double(cells, lengths, stride, count, column.doubles.data() + first);
+                break;
+            }
+            case COLUMN_STRING: {
+                size_t size = column.data.size();
+                for (size_t i = 0; i < count; ++i)
+                    if (cells[i * stride]) size += lengths[i * stride];
+                column.data.resize(size);
+                column.offsets.resize(first + count + 1);
+                int64_t* offsets = column.offsets.data() + first;
+                char* out = column.data.data();
+                for (size_t i = 0; i < count; ++i) {
+                    const char* cell = cells[i * stride];
+                    const unsigned long len = cell ? lengths[i * stride] : 0;
+                    if (len) std::memcpy(out + offsets[i], cell, len);
+                    offsets[i + 1] = offsets[i] + len;
+                }
+                break;
+            }
+        }
+    }
+
+    const ColumnarResult::Column& ColumnarResult::column(std::string_view name) const {
+        const int col = _index.find(name);
+        if (col < 0) throw mariadb_error("unknown column name \"" + std::string(name) + "\".");
+        return _columns[col];
+    }
+}
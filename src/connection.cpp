@@ -24,6 +24,7 @@
 #include <cassert>
 #include <cstring>
 #include <memory>
+#include <optional>
 #include <sstream>
 #ifdef MARIADB_VERSION_ID
 #ifdef WIN32
@@ -40,9 +41,9 @@ int poll(struct pollfd* pfds, unsigned long int nfds, int timeout) {
 
 namespace MariaCpp {
 
-    Connection::Connection()
+    Connection::Connection() : _dirty(), _retry(&RetryPolicy::defaults())
 #   ifdef MARIADB_VERSION_ID
-            : _async_status()
+            , _async_status()
 #   endif
     {
         mysql_init(&mysql);
@@ -52,6 +53,22 @@ namespace MariaCpp {
         close();
     }
 
+    void Connection::clear_session() {
+        _dirty = false;
+        if (_stmt_cache) _stmt_cache->clear();
+    }
+
+    // Cache is kept (not replaced) as outstanding leases refer to it
+    void Connection::set_statement_cache(size_t capacity) {
+        if (_stmt_cache) _stmt_cache->set_capacity(capacity);
+        else if (capacity) _stmt_cache.reset(new StatementCache(*this, capacity));
+    }
+
+    StatementCache::Lease Connection::prepare_cached(const std::string& sql) {
+        if (!_stmt_cache) _stmt_cache.reset(new StatementCache(*this, 0));
+        return _stmt_cache->acquire(sql);
+    }
+
     void Connection::connect(const Uri& uri, const char* usr, const char* passwd, unsigned long clientflag) {
         // unsigned int protocol = 0;
         // switch(uri.protocol()) {
@@ -68,6 +85,7 @@ namespace MariaCpp {
     void Connection::close() {
         // Calling mysql_close() twice would crash MariaDB Connector/C,
         // therefore we have to protect against it
+        if (_stmt_cache) _stmt_cache->clear();
         if (mysql.methods) mysql_close(&mysql);
         mysql.methods = NULL;
     }
@@ -76,6 +94,7 @@ namespace MariaCpp {
                              unsigned long clientflag) {
         if (!mysql_real_connect(&mysql, host, user, passwd, db, port, unix_socket, clientflag))
             throw_exception();
+        _dirty = false;
     }
 
     std::string Connection::escape_string(const std::string& s) {
@@ -117,6 +136,21 @@ namespace MariaCpp {
         return !res;
     }
 
+    expected<void> Connection::try_query(const char* sql, unsigned long length) noexcept {
+        CC();
+        _dirty = true;
+        for (unsigned attempt = 1; mysql_real_query(&mysql, sql, length); ++attempt)
+            if (!_retry->retry(attempt, errorno())) return std::unexpected(error_code());
+        return {};
+    }
+
+    expected<bool> Connection::try_next_result() noexcept {
+        CC();
+        int res = mysql_next_result(&mysql);
+        if (0 < res) return std::unexpected(error_code());
+        return !res;
+    }
+
     void Connection::options(enum mysql_option option, const void* arg) {
         if (!mysql_options(&mysql, option, arg)) return;
         std::ostringstream msg;
@@ -176,6 +210,7 @@ namespace MariaCpp {
     }
 
     MYSQL_STMT* Connection::stmt_init() {
+        _dirty = true; // server-side statement is part of session state
         MYSQL_STMT* stmt = mysql_stmt_init(&mysql);
         if (!stmt) throw_exception();
         return stmt;
@@ -197,7 +232,7 @@ namespace MariaCpp {
         auto err_str = error_str();
         auto error_no = errorno();
         auto state = sqlstate();
-        throw mariadb_error(err_str, error_no, state);
+        mariadb_error::raise(err_str, error_no, state);
     }
 
 #ifdef MARIADB_VERSION_ID
@@ -242,6 +277,7 @@ namespace MariaCpp {
     void Connection::autocommit_start(bool mode) {
         assert(!_async_status);
         my_bool ret;
+        _dirty = true;
         _async_status = mysql_autocommit_start(&ret, &mysql, mode);
         if (!_async_status && ret) throw_exception();
     }
@@ -291,6 +327,7 @@ namespace MariaCpp {
         MYSQL* ret;
         _async_status = mysql_real_connect_start(&ret, &mysql, host, user, passwd, db, port, unix_socket, clientflag);
         if (!_async_status && ret == nullptr) throw_exception();
+        if (!_async_status) _dirty = false;
     }
 
     void Connection::connect_cont(int status) {
@@ -298,6 +335,7 @@ namespace MariaCpp {
         MYSQL* ret;
         _async_status = mysql_real_connect_cont(&ret, &mysql, status);
         if (!_async_status && ret == nullptr) throw_exception();
+        if (!_async_status) _dirty = false;
     }
 
     ResultSet* Connection::list_fields_start(const char* table, const char* wild) {
@@ -341,6 +379,7 @@ namespace MariaCpp {
     void Connection::query_start(const char* sql, unsigned long length) {
         assert(!_async_status);
         int ret;
+        _dirty = true;
         _async_status = mysql_real_query_start(&ret, &mysql, sql, length);
         if (!_async_status && ret) throw_exception();
     }
@@ -352,6 +391,39 @@ namespace MariaCpp {
         if (!_async_status && ret) throw_exception();
     }
 
+    expected<void> Connection::try_query_start(const char* sql, unsigned long length) noexcept {
+        assert(!_async_status);
+        int ret;
+        _dirty = true;
+        _async_status = mysql_real_query_start(&ret, &mysql, sql, length);
+        if (!_async_status && ret) return std::unexpected(error_code());
+        return {};
+    }
+
+    expected<void> Connection::try_query_cont(int status) noexcept {
+        assert(_async_status);
+        int ret;
+        _async_status = mysql_real_query_cont(&ret, &mysql, status);
+        if (!_async_status && ret) return std::unexpected(error_code());
+        return {};
+    }
+
+    expected<bool> Connection::try_next_result_start() noexcept {
+        assert(!_async_status);
+        int ret = 0;
+        _async_status = mysql_next_result_start(&ret, &mysql);
+        if (!_async_status && 0 < ret) return std::unexpected(error_code());
+        return !ret;
+    }
+
+    expected<bool> Connection::try_next_result_cont(int status) noexcept {
+        assert(_async_status);
+        int ret = 0;
+        _async_status = mysql_next_result_cont(&ret, &mysql, status);
+        if (!_async_status && 0 < ret) return std::unexpected(error_code());
+        return !ret;
+    }
+
     void Connection::rollback_start() {
         assert(!_async_status);
         my_bool ret;
@@ -369,6 +441,7 @@ namespace MariaCpp {
     void Connection::select_db_start(const char* db) {
         assert(!_async_status);
         int ret;
+        _dirty = true;
         _async_status = mysql_select_db_start(&ret, &mysql, db);
         if (!_async_status && ret) throw_exception();
     }
@@ -401,6 +474,7 @@ namespace MariaCpp {
     void Connection::set_character_set_start(const char* csname) {
         assert(!_async_status);
         int ret;
+        _dirty = true;
         _async_status = mysql_set_character_set_start(&ret, &mysql, csname);
         if (!_async_status && ret) throw_exception();
     }
@@ -417,6 +491,7 @@ namespace MariaCpp {
         my_bool ret;
         _async_status = mysql_change_user_start(&ret, &mysql, usr, pas, db);
         if (!_async_status && ret) throw_exception();
+        if (!_async_status) clear_session();
     }
 
     void Connection::change_user_cont(int status) {
@@ -424,11 +499,13 @@ namespace MariaCpp {
         my_bool ret;
         _async_status = mysql_change_user_cont(&ret, &mysql, status);
         if (!_async_status && ret) throw_exception();
+        if (!_async_status) clear_session();
     }
 
     void Connection::send_query_start(const char* sql, unsigned long length) {
         assert(!_async_status);
         int ret;
+        _dirty = true;
         _async_status = mysql_send_query_start(&ret, &mysql, sql, length);
         if (!_async_status && ret) throw_exception();
     }
@@ -499,6 +576,7 @@ namespace MariaCpp {
     void Connection::set_server_option_start(enum enum_mysql_set_option option) {
         assert(!_async_status);
         int ret;
+        _dirty = true;
         _async_status = mysql_set_server_option_start(&ret, &mysql, option);
         if (!_async_status && ret) throw_exception();
     }
@@ -545,6 +623,7 @@ namespace MariaCpp {
         int ret;
         _async_status = mysql_reset_connection_start(&ret, &mysql);
         if (!_async_status && ret) throw_exception();
+        if (!_async_status) clear_session();
     }
 
     void Connection::reset_connection_cont(int status) {
@@ -552,6 +631,73 @@ namespace MariaCpp {
         int ret;
         _async_status = mysql_reset_connection_cont(&ret, &mysql, status);
         if (!_async_status && ret) throw_exception();
+        if (!_async_status) clear_session();
+    }
+
+    Awaitable<void> Connection::autocommit_async(bool mode) {
+        return Awaitable<void>(*this, [this, mode] { autocommit_start(mode); },
+                               [this](int status) { autocommit_cont(status); });
+    }
+
+    Awaitable<void> Connection::commit_async() {
+        return Awaitable<void>(*this, [this] { commit_start(); },
+                               [this](int status) { commit_cont(status); });
+    }
+
+    // Null user/password (defaults of mysql_real_connect()) is passed through
+    static std::optional<std::string> optional_str(const char* str) {
+        return str ? std::optional<std::string>(str) : std::nullopt;
+    }
+
+    static const char* c_str(const std::optional<std::string>& str) {
+        return str ? str->c_str() : nullptr;
+    }
+
+    Awaitable<void> Connection::connect_async(const Uri& uri, const char* usr, const char* passwd, unsigned long clientflag) {
+        return Awaitable<void>(*this, [this, uri, u = optional_str(usr), p = optional_str(passwd), clientflag] {
+                                   connect_start(uri, c_str(u), c_str(p), clientflag);
+                               }, [this](int status) { connect_cont(status); });
+    }
+
+    Awaitable<bool> Connection::next_result_async() {
+        return Awaitable<bool>(*this, [this] { return next_result_start(); },
+                               [this](int status) { return next_result_cont(status); });
+    }
+
+    Awaitable<void> Connection::query_async(std::string sql) {
+        return Awaitable<void>(*this, [this, sql = std::move(sql)] { query_start(sql); },
+                               [this](int status) { query_cont(status); });
+    }
+
+    Awaitable<void> Connection::rollback_async() {
+        return Awaitable<void>(*this, [this] { rollback_start(); },
+                               [this](int status) { rollback_cont(status); });
+    }
+
+    Awaitable<void> Connection::select_db_async(std::string db) {
+        return Awaitable<void>(*this, [this, db = std::move(db)] { select_db_start(db.c_str()); },
+                               [this](int status) { select_db_cont(status); });
+    }
+
+    Awaitable<ResultSet*> Connection::store_result_async() {
+        return Awaitable<ResultSet*>(*this, [this] { return store_result_start(); },
+                                     [this](int status) { return store_result_cont(status); });
+    }
+
+    Awaitable<void> Connection::change_user_async(std::string usr, std::string pas, std::string db) {
+        return Awaitable<void>(*this, [this, usr = std::move(usr), pas = std::move(pas), db = std::move(db)] {
+                                   change_user_start(usr.c_str(), pas.c_str(), db.empty() ? nullptr : db.c_str());
+                               }, [this](int status) { change_user_cont(status); });
+    }
+
+    Awaitable<void> Connection::ping_async() {
+        return Awaitable<void>(*this, [this] { ping_start(); },
+                               [this](int status) { ping_cont(status); });
+    }
+
+    Awaitable<void> Connection::reset_connection_async() {
+        return Awaitable<void>(*this, [this] { reset_connection_start(); },
+                               [this](int status) { reset_connection_cont(status); });
     }
 
 #endif /* MARIADB_VERSION_ID */
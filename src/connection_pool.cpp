@@ -0,0 +1,355 @@
+/****************************************************************************
+  Copyright (C) 2015 Karol Roslaniec <mariacpp@roslaniec.net>
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not see <http://www.gnu.org/licenses>
+  or write to the Free Software Foundation, Inc.,
+  51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+*****************************************************************************/
+#include <mariacpp/connection_pool.hpp>
+#include <mariacpp/mariadb_error.hpp>
+#include <mariacpp/prepared_stmt.hpp>
+#include <algorithm>
+#include <cassert>
+#include <cerrno>
+#include <chrono>
+#include <cstdint>
+#include <exception>
+#include <thread>
+#ifdef MARIADB_VERSION_ID
+#ifdef WIN32
+#include <winsock2.h>
+#else
+#include <poll.h>
+#endif
+#endif
+
+namespace MariaCpp {
+
+    static std::atomic<unsigned> next_thread_hint;
+
+    // Checked before slots are allocated; slot index must stay below npos (UINT32_MAX)
+    static size_t checked_size(size_t size) {
+        if (!size || UINT32_MAX <= size)
+            throw InvalidArgumentException("Invalid connection pool size");
+        return size;
+    }
+
+    ConnectionPool::ConnectionPool(const Uri& uri, const char* user, const char* passwd, size_t size, unsigned long clientflag)
+            : _uri(uri), _user(user ? user : ""), _passwd(passwd ? passwd : ""), _clientflag(clientflag), _size(checked_size(size)),
+              _shard_count(std::max(1u, std::thread::hardware_concurrency())), _slots(new Slot[_size]()), _shards(new Shard[_shard_count]()),
+              _available(0), _releases(0), _reset_on_return(true) {
+        // Spread (not yet connected) slots evenly among shards
+        for (uint32_t i = 0; i < _size; ++i)
+            push(_shards[i % _shard_count], i);
+        _available = _size;
+    }
+
+    ConnectionPool::~ConnectionPool() {
+        assert(_available == _size); // Lease outlived its pool?
+    }
+
+    // Every thread sticks to one shard, threads are assigned round-robin.
+    ConnectionPool::Shard& ConnectionPool::local_shard() {
+        static thread_local const unsigned hint = next_thread_hint.fetch_add(1, std::memory_order_relaxed);
+        return _shards[hint % _shard_count];
+    }
+
+    uint32_t ConnectionPool::pop(Shard& shard) {
+        uint64_t head = shard.head.load(std::memory_order_acquire);
+        while (const auto top = static_cast<uint32_t>(head)) {
+            const uint64_t next = _slots[top - 1].next.load(std::memory_order_relaxed);
+            // Tag is bumped on every change to protect against ABA
+            const uint64_t repl = ((head >> 32) + 1) << 32 | next;
+            if (shard.head.compare_exchange_weak(head, repl, std::memory_order_acquire, std::memory_order_acquire))
+                return top - 1;
+        }
+        return npos;
+    }
+
+    void ConnectionPool::push(Shard& shard, uint32_t idx) {
+        uint64_t head = shard.head.load(std::memory_order_relaxed);
+        uint64_t repl;
+        do {
+            _slots[idx].next.store(static_cast<uint32_t>(head), std::memory_order_relaxed);
+            repl = ((head >> 32) + 1) << 32 | (idx + 1);
+        } while (!shard.head.compare_exchange_weak(head, repl, std::memory_order_release, std::memory_order_relaxed));
+    }
+
+    // Pops free slot from local shard, or steals one from other shards
+    uint32_t ConnectionPool::take() {
+        Shard& local = local_shard();
+        uint32_t idx = pop(local);
+        if (npos == idx) {
+            const size_t first = &local - _shards.get();
+            for (size_t i = 1; i < _shard_count && npos == idx; ++i)
+                idx = pop(_shards[(first + i) % _shard_count]);
+        }
+        if (npos != idx) _available.fetch_sub(1, std::memory_order_relaxed);
+        return idx;
+    }
+
+    void ConnectionPool::open(Slot& slot) {
+        slot.conn.emplace();
+#   ifdef MARIADB_VERSION_ID
+        slot.conn->options(MYSQL_OPT_NONBLOCK, nullptr);
+#   endif
+        if (_init) _init(*slot.conn);
+        slot.stmts.resize(_statements.size());
+    }
+
+    void ConnectionPool::drop(Slot& slot) noexcept {
+        slot.reset_pending = false;
+        slot.stmts.clear(); // before its connection
+        slot.conn.reset();
+    }
+
+    ConnectionPool::Lease ConnectionPool::lease(uint32_t idx) {
+        Slot& slot = _slots[idx];
+#   ifdef MARIADB_VERSION_ID
+        if (slot.reset_pending) {
+            slot.reset_pending = false;
+            try {
+                while (slot.conn->async_status())
+                    slot.conn->reset_connection_cont(slot.conn->async_wait());
+                // Server has forgotten them; re-prepared on demand
+                for (auto& stmt : slot.stmts) stmt.reset();
+            } catch (mariadb_error&) {
+                drop(slot); // reconnect below
+            }
+        }
+#   endif
+        if (!slot.conn) {
+            try {
+                open(slot);
+                slot.conn->connect(_uri, _user.c_str(), _passwd.c_str(), _clientflag);
+            } catch (...) {
+                drop(slot);
+                release(idx);
+                throw;
+            }
+        }
+        return Lease(this, idx);
+    }
+
+    ConnectionPool::Lease ConnectionPool::acquire() {
+        for (;;) {
+            const uint32_t seen = _releases.load(std::memory_order_acquire);
+            const uint32_t idx = take();
+            if (npos != idx) return lease(idx);
+            // Sleep until any release() since "seen" snapshot
+            _releases.wait(seen, std::memory_order_acquire);
+        }
+    }
+
+    ConnectionPool::Lease ConnectionPool::try_acquire() {
+        const uint32_t idx = take();
+        return npos == idx ? Lease() : lease(idx);
+    }
+
+    // Starts reset of dirty connection, next lease() will finish it.
+    // Connection left in unknown state is closed (reopened on demand).
+    void ConnectionPool::recycle(Slot& slot) noexcept {
+        if (!slot.conn) return;
+        try {
+#   ifdef MARIADB_VERSION_ID
+            if (slot.conn->async_status()) { // abandoned non-blocking call
+                drop(slot);
+                return;
+            }
+#   endif
+            for (auto& stmt : slot.stmts)
+                if (stmt) stmt->free_result();
+            if (!_reset_on_return) return;
+#   ifdef MARIADB_VERSION_ID
+            if (!slot.conn->dirty() && !(slot.conn->server_status() & SERVER_STATUS_IN_TRANS)) return;
+            slot.conn->reset_connection_start();
+            slot.reset_pending = slot.conn->async_status();
+            if (!slot.reset_pending)
+                for (auto& stmt : slot.stmts) stmt.reset();
+#   else
+            if (!slot.conn->dirty()) return;
+            slot.conn->reset_connection();
+            for (auto& stmt : slot.stmts) stmt.reset();
+#   endif
+        } catch (...) {
+            drop(slot);
+        }
+    }
+
+#ifdef MARIADB_VERSION_ID
+
+    static int wait_any(struct pollfd* pfds, size_t count, int timeout) {
+#   ifdef WIN32
+        return WSAPoll(pfds, static_cast<ULONG>(count), timeout);
+#   else
+        return poll(pfds, count, timeout);
+#   endif
+    }
+
+    size_t ConnectionPool::warm_up(size_t count) {
+        typedef std::chrono::steady_clock clock;
+        if (!count || _size < count) count = _size;
+
+        // Take all free slots, so nobody else will touch them meanwhile
+        std::vector<uint32_t> taken;
+        for (uint32_t idx; npos != (idx = take());) taken.push_back(idx);
+
+        //  Every connection runs its own sequence of non-blocking steps:
+        //  step 0 is connect, step i > 0 is prepare of (i-1)-th statement.
+        struct Pending {
+            uint32_t idx;
+            size_t step;
+            clock::time_point deadline;
+        };
+        std::vector<Pending> pending;
+        std::exception_ptr error;
+        size_t opened = 0;
+
+        // Starts following steps until one of them has to wait.
+        // Returns false when all steps are done.
+        auto advance = [&](Pending& p) {
+            Slot& slot = _slots[p.idx];
+            Connection& conn = *slot.conn;
+            while (!conn.async_status()) {
+                if (_statements.size() <= p.step) {
+                    conn._dirty = false; // pool statements only
+                    ++opened;
+                    return false;
+                }
+                slot.stmts[p.step].reset(new PreparedStatement(conn));
+                slot.stmts[p.step]->prepare_start(_statements[p.step]);
+                ++p.step;
+            }
+            if (conn.async_status() & MYSQL_WAIT_TIMEOUT)
+                p.deadline = clock::now() + std::chrono::milliseconds(conn.get_timeout_value_ms());
+            return true;
+        };
+
+        auto fail = [&](Pending& p) {
+            if (!error) error = std::current_exception();
+            drop(_slots[p.idx]);
+        };
+
+        for (uint32_t idx : taken) {
+            Slot& slot = _slots[idx];
+            if (slot.conn || pending.size() == count) continue;
+            Pending p = {idx, 0, clock::time_point()};
+            try {
+                open(slot);
+                slot.conn->connect_start(_uri, _user.c_str(), _passwd.c_str(), _clientflag);
+                if (advance(p)) pending.push_back(p);
+            } catch (...) {
+                fail(p);
+            }
+        }
+
+        std::vector<struct pollfd> pfds;
+        while (!pending.empty()) {
+            int timeout = -1;
+            const clock::time_point now = clock::now();
+            pfds.resize(pending.size());
+            for (size_t i = 0; i < pending.size(); ++i) {
+                Connection& conn = *_slots[pending[i].idx].conn;
+                const int status = conn.async_status();
+                pfds[i].fd = conn.get_socket();
+                pfds[i].events = (status & MYSQL_WAIT_READ ? POLLIN : 0)
+                                 | (status & MYSQL_WAIT_WRITE ? POLLOUT : 0)
+                                 | (status & MYSQL_WAIT_EXCEPT ? POLLPRI : 0);
+                pfds[i].revents = 0;
+                if (status & MYSQL_WAIT_TIMEOUT) {
+                    const auto left = std::chrono::ceil<std::chrono::milliseconds>(pending[i].deadline - now).count();
+                    const int ms = static_cast<int>(std::max<decltype(left)>(left, 0));
+                    if (timeout < 0 || ms < timeout) timeout = ms;
+                }
+            }
+            // Broken poll: report timeout to everybody (as async_wait() does)
+            const bool broken = wait_any(pfds.data(), pfds.size(), timeout) < 0 && errno != EINTR;
+
+            const clock::time_point after = clock::now();
+            for (size_t i = pending.size(); i--;) {
+                Pending& p = pending[i];
+                Slot& slot = _slots[p.idx];
+                const int waits = slot.conn->async_status();
+                int status = (pfds[i].revents & (POLLIN | POLLERR | POLLHUP) ? MYSQL_WAIT_READ : 0)
+                             | (pfds[i].revents & POLLOUT ? MYSQL_WAIT_WRITE : 0)
+                             | (pfds[i].revents & POLLPRI ? MYSQL_WAIT_EXCEPT : 0);
+                if (broken || (!status && (waits & MYSQL_WAIT_TIMEOUT) && p.deadline <= after))
+                    status = MYSQL_WAIT_TIMEOUT;
+                if (!status) continue;
+                bool done;
+                try {
+                    if (!p.step) slot.conn->connect_cont(status);
+                    else slot.stmts[p.step - 1]->prepare_cont(status);
+                    done = !advance(p);
+                } catch (...) {
+                    fail(p);
+                    done = true;
+                }
+                if (done) pending.erase(pending.begin() + i);
+            }
+        }
+
+        for (uint32_t idx : taken) release(idx);
+        if (error) std::rethrow_exception(error);
+        return opened;
+    }
+
+#else
+
+    size_t ConnectionPool::warm_up(size_t count) {
+        if (!count || _size < count) count = _size;
+        std::vector<uint32_t> taken;
+        for (uint32_t idx; npos != (idx = take());) taken.push_back(idx);
+        std::exception_ptr error;
+        size_t opened = 0;
+        for (uint32_t idx : taken) {
+            Slot& slot = _slots[idx];
+            if (slot.conn || opened == count) continue;
+            try {
+                open(slot);
+                slot.conn->connect(_uri, _user.c_str(), _passwd.c_str(), _clientflag);
+                for (size_t i = 0; i < _statements.size(); ++i)
+                    slot.stmts[i].reset(slot.conn->prepare(_statements[i]));
+                slot.conn->_dirty = false; // pool statements only
+                ++opened;
+            } catch (...) {
+                if (!error) error = std::current_exception();
+                drop(slot);
+            }
+        }
+        for (uint32_t idx : taken) release(idx);
+        if (error) std::rethrow_exception(error);
+        return opened;
+    }
+
+#endif /* MARIADB_VERSION_ID */
+
+    void ConnectionPool::release(uint32_t idx) {
+        assert(idx < _size);
+        push(local_shard(), idx);
+        _available.fetch_add(1, std::memory_order_relaxed);
+        _releases.fetch_add(1, std::memory_order_release);
+        _releases.notify_one();
+    }
+
+    PreparedStatement& ConnectionPool::Lease::statement(size_t i) const {
+        assert(_pool && i < _pool->_statements.size());
+        Slot& slot = _pool->_slots[_idx];
+        if (!slot.stmts[i]) {
+            Connection::ReadOnly ro(*slot.conn);
+            slot.stmts[i].reset(slot.conn->prepare(_pool->_statements[i]));
+        }
+        return *slot.stmts[i];
+    }
+}
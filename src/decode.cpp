@@ -0,0 +1,206 @@
+/****************************************************************************
+  Copyright (C) 2015 Karol Roslaniec <mariacpp@roslaniec.net>
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not see <http://www.gnu.org/licenses>
+  or write to the Free Software Foundation, Inc.,
+  51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+*****************************************************************************/
+#include <mariacpp/bits/decode.hpp>
+#include <mariacpp/bits/parse.hpp>
+#include <atomic>
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#define MARIACPP_DECODE_SIMD 1
+#include <immintrin.h>
+#endif
+
+namespace MariaCpp {
+
+    template<typename T>
+    static void decode_scalar(const char* const* cells, const unsigned long* lengths,
+                              size_t stride, size_t count, T* out) {
+        for (size_t i = 0; i < count; ++i) {
+            const char* cell = cells[i * stride];
+            out[i] = cell ? from_chars<T>(cell, cell + lengths[i * stride]) : 0;
+        }
+    }
+
+#ifdef MARIACPP_DECODE_SIMD
+
+    // pshufb masks moving len leading bytes to the end of 16-byte
+    // vector (least significant digit last), zeroing the rest
+    struct ShuffleTable {
+        alignas(16) uint8_t mask[17][16];
+
+        constexpr ShuffleTable() : mask() {
+            for (int len = 0; len <= 16; ++len)
+                for (int i = 0; i < 16; ++i)
+                    mask[len][i] = i < 16 - len ? 0x80 : static_cast<uint8_t>(i - (16 - len));
+        }
+    };
+
+    static constexpr ShuffleTable shuffle_table;
+
+    // Digits of cell eligible for SIMD kernel: 1-16 digits after
+    // optional sign, and 16 bytes can be loaded without crossing page
+    struct Digits {
+        const char* data;
+        size_t length;
+        bool negative;
+    };
+
+    static inline bool simd_digits(const char* cell, unsigned long length, bool is_signed, Digits& digits) {
+        if (!cell || !length) return false;
+        digits.negative = is_signed && '-' == *cell;
+        digits.data = cell + digits.negative;
+        digits.length = length - digits.negative;
+        return 0 < digits.length && digits.length <= 16
+               && (reinterpret_cast<uintptr_t>(digits.data) & 4095) <= 4096 - 16;
+    }
+
+    template<typename T>
+    static inline T apply_sign(uint64_t value, bool negative) {
+        return negative ? static_cast<T>(0 - value) : static_cast<T>(value);
+    }
+
+    // Converts up to 16 digits to number. Bytes past the cell are loaded
+    // (see simd_digits()) but ignored, hence no_sanitize_address.
+    __attribute__((target("sse4.2"), no_sanitize_address))
+    static inline bool sse_parse(const Digits& digits, uint64_t& value) {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(digits.data));
+        v = _mm_sub_epi8(v, _mm_set1_epi8('0'));
+        v = _mm_shuffle_epi8(v, _mm_load_si128(reinterpret_cast<const __m128i*>(shuffle_table.mask[digits.length])));
+        if (_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_min_epu8(v, _mm_set1_epi8(9)), v)) != 0xFFFF) return false;
+        v = _mm_maddubs_epi16(v, _mm_setr_epi8(10, 1, 10, 1, 10, 1, 10, 1, 10, 1, 10, 1, 10, 1, 10, 1));
+        v = _mm_madd_epi16(v, _mm_setr_epi16(100, 1, 100, 1, 100, 1, 100, 1));
+        v = _mm_packus_epi32(v, v);
+        v = _mm_madd_epi16(v, _mm_setr_epi16(10000, 1, 10000, 1, 10000, 1, 10000, 1));
+        value = static_cast<uint64_t>(static_cast<uint32_t>(_mm_cvtsi128_si32(v))) * 100000000
+                + static_cast<uint32_t>(_mm_extract_epi32(v, 1));
+        return true;
+    }
+
+    template<typename T>
+    __attribute__((target("sse4.2")))
+    static void decode_sse42(const char* const* cells, const unsigned long* lengths,
+                             size_t stride, size_t count, T* out) {
+        for (size_t i = 0; i < count; ++i) {
+            const char* cell = cells[i * stride];
+            Digits digits;
+            uint64_t value;
+            if (simd_digits(cell, lengths[i * stride], std::is_signed<T>::value, digits) && sse_parse(digits, value))
+                out[i] = apply_sign<T>(value, digits.negative);
+            else out[i] = cell ? from_chars<T>(cell, cell + lengths[i * stride]) : 0;
+        }
+    }
+
+    // Same as sse_parse(), two cells at once (one per 128-bit lane)
+    __attribute__((target("avx2"), no_sanitize_address))
+    static inline bool avx2_parse(const Digits& a, const Digits& b, uint64_t& value_a, uint64_t& value_b) {
+        __m256i v = _mm256_inserti128_si256(
+                _mm256_castsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i*>(a.data))),
+                _mm_loadu_si128(reinterpret_cast<const __m128i*>(b.data)), 1);
+        const __m256i mask = _mm256_inserti128_si256(
+                _mm256_castsi128_si256(_mm_load_si128(reinterpret_cast<const __m128i*>(shuffle_table.mask[a.length]))),
+                _mm_load_si128(reinterpret_cast<const __m128i*>(shuffle_table.mask[b.length])), 1);
+        v = _mm256_sub_epi8(v, _mm256_set1_epi8('0'));
+        v = _mm256_shuffle_epi8(v, mask);
+        if (_mm256_movemask_epi8(_mm256_cmpeq_epi8(_mm256_min_epu8(v, _mm256_set1_epi8(9)), v)) != -1) return false;
+        v = _mm256_maddubs_epi16(v, _mm256_setr_epi8(10, 1, 10, 1, 10, 1, 10, 1, 10, 1, 10, 1, 10, 1, 10, 1,
+                                                     10, 1, 10, 1, 10, 1, 10, 1, 10, 1, 10, 1, 10, 1, 10, 1));
+        v = _mm256_madd_epi16(v, _mm256_setr_epi16(100, 1, 100, 1, 100, 1, 100, 1, 100, 1, 100, 1, 100, 1, 100, 1));
+        v = _mm256_packus_epi32(v, v);
+        v = _mm256_madd_epi16(v, _mm256_setr_epi16(10000, 1, 10000, 1, 10000, 1, 10000, 1,
+                                                   10000, 1, 10000, 1, 10000, 1, 10000, 1));
+        value_a = static_cast<uint64_t>(static_cast<uint32_t>(_mm256_extract_epi32(v, 0))) * 100000000
+                  + static_cast<uint32_t>(_mm256_extract_epi32(v, 1));
+        value_b = static_cast<uint64_t>(static_cast<uint32_t>(_mm256_extract_epi32(v, 4))) * 100000000
+                  + static_cast<uint32_t>(_mm256_extract_epi32(v, 5));
+        return true;
+    }
+
+    template<typename T>
+    __attribute__((target("avx2")))
+    static void decode_avx2(const char* const* cells, const unsigned long* lengths,
+                            size_t stride, size_t count, T* out) {
+        size_t i = 0;
+        for (; i + 1 < count; i += 2) {
+            Digits a, b;
+            uint64_t value_a, value_b;
+            if (simd_digits(cells[i * stride], lengths[i * stride], std::is_signed<T>::value, a)
+                && simd_digits(cells[(i + 1) * stride], lengths[(i + 1) * stride], std::is_signed<T>::value, b)
+                && avx2_parse(a, b, value_a, value_b)) {
+                out[i] = apply_sign<T>(value_a, a.negative);
+                out[i + 1] = apply_sign<T>(value_b, b.negative);
+            } else decode_sse42(cells + i * stride, lengths + i * stride, stride, 2, out + i);
+        }
+        if (i < count) decode_sse42(cells + i * stride, lengths + i * stride, stride, count - i, out + i);
+    }
+
+    static decode_kernel detect_kernel() {
+        __builtin_cpu_init();
+        if (__builtin_cpu_supports("avx2")) return DECODE_AVX2;
+        if (__builtin_cpu_supports("sse4.2")) return DECODE_SSE42;
+        return DECODE_SCALAR;
+    }
+
+#else
+
+    static decode_kernel detect_kernel() {
+        return DECODE_SCALAR;
+    }
+
+#endif /* MARIACPP_DECODE_SIMD */
+
+    static const decode_kernel supported_kernel = detect_kernel();
+
+    static std::atomic<decode_kernel> kernel_in_use(supported_kernel);
+
+    decode_kernel decode_kernel_in_use() {
+        return kernel_in_use.load(std::memory_order_relaxed);
+    }
+
+    void set_decode_kernel(decode_kernel kernel) {
+        kernel_in_use.store(kernel < supported_kernel ? kernel : supported_kernel, std::memory_order_relaxed);
+    }
+
+    template<typename T>
+    static void decode(const char* const* cells, const unsigned long* lengths,
+                       size_t stride, size_t count, T* out) {
+        switch (decode_kernel_in_use()) {
+#   ifdef MARIACPP_DECODE_SIMD
+            case DECODE_AVX2:
+                return decode_avx2(cells, lengths, stride, count, out);
+            case DECODE_SSE42:
+                return decode_sse42(cells, lengths, stride, count, out);
+#   endif
+            default:
+                return decode_scalar(cells, lengths, stride, count, out);
+        }
+    }
+
+    void decode_int64(const char* const* cells, const unsigned long* lengths,
+                      size_t stride, size_t count, int64_t* out) {
+        decode(cells, lengths, stride, count, out);
+    }
+
+    void decode_uint64(const char* const* cells, const unsigned long* lengths,
+                       size_t stride, size_t count, uint64_t* out) {
+        decode(cells, lengths, stride, count, out);
+    }
+
+    void decode_double(const char* const* cells, const unsigned long* lengths,
+                       size_t stride, size_t count, double* out) {
+        decode_scalar(cells, lengths, stride, count, out);
+    }
+}
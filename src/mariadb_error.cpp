@@ -0,0 +1,78 @@
+/****************************************************************************
+  Copyright (C) 2015 Karol Roslaniec <mariacpp@roslaniec.net>
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not see <http://www.gnu.org/licenses>
+  or write to the Free Software Foundation, Inc.,
+  51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+*****************************************************************************/
+#include <mariacpp/mariadb_error.hpp>
+#include <errmsg.h>
+#include <mysqld_error.h>
+#include <atomic>
+#include <cstring>
+
+namespace MariaCpp {
+
+    static std::atomic<unsigned> stacktrace_categories(0);
+
+    void mariadb_error::capture_stacktrace(unsigned categories, bool enable) {
+        if (enable) stacktrace_categories.fetch_or(categories, std::memory_order_relaxed);
+        else stacktrace_categories.fetch_and(~categories, std::memory_order_relaxed);
+    }
+
+    bool mariadb_error::captures_stacktrace(unsigned category) {
+        return stacktrace_categories.load(std::memory_order_relaxed) & category;
+    }
+
+    error_category mariadb_error::classify(unsigned number, const char* sqlstate) {
+        switch (number) {
+            case ER_LOCK_DEADLOCK:
+            case ER_LOCK_WAIT_TIMEOUT:
+                return ERROR_LOCK;
+            case CR_CONNECTION_ERROR:
+            case CR_CONN_HOST_ERROR:
+            case CR_UNKNOWN_HOST:
+            case CR_SERVER_GONE_ERROR:
+            case CR_SERVER_LOST:
+                return ERROR_CONNECTION;
+            default:
+                break;
+        }
+        if (!sqlstate || std::strlen(sqlstate) < 2) return ERROR_OTHER;
+        // SQLSTATE class (first 2 characters)
+        if (!std::strncmp(sqlstate, "08", 2)) return ERROR_CONNECTION;
+        if (!std::strncmp(sqlstate, "40", 2)) return ERROR_LOCK;
+        if (!std::strncmp(sqlstate, "23", 2)) return ERROR_INTEGRITY;
+        if (!std::strncmp(sqlstate, "42", 2)) return ERROR_SYNTAX;
+        if (!std::strncmp(sqlstate, "22", 2)) return ERROR_DATA;
+        return ERROR_OTHER;
+    }
+
+    void mariadb_error::raise(const char* str, unsigned number, const char* sqlstate) {
+        switch (classify(number, sqlstate)) {
+            case ERROR_CONNECTION:
+                throw connection_error(str, number, sqlstate);
+            case ERROR_LOCK:
+                throw lock_error(str, number, sqlstate);
+            case ERROR_INTEGRITY:
+                throw integrity_error(str, number, sqlstate);
+            case ERROR_SYNTAX:
+                throw syntax_error(str, number, sqlstate);
+            case ERROR_DATA:
+                throw data_error(str, number, sqlstate);
+            default:
+                throw mariadb_error(str, number, sqlstate);
+        }
+    }
+}
@@ -0,0 +1,165 @@
+/****************************************************************************
+  Copyright (C) 2015 Karol Roslaniec <mariacpp@roslaniec.net>
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not see <http://www.gnu.org/licenses>
+  or write to the Free Software Foundation, Inc.,
+  51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+*****************************************************************************/
+#include <mariacpp/prefetch_result.hpp>
+#include <mariacpp/lib.hpp>
+#include <mariacpp/mariadb_error.hpp>
+#include <mariacpp/resultset.hpp>
+#include <mariacpp/bits/parse.hpp>
+#include <utility>
+
+namespace MariaCpp {
+
+    PrefetchResult::PrefetchResult(ResultSet& res, size_t batch_rows, size_t capacity)
+            : _res(res), _fields(res.num_fields()), _batch_rows(batch_rows), _capacity(capacity),
+              _head(0), _tail(0), _stop(false), _batch(), _row(), _cell() {
+        // Consumer holds one batch, reader needs another one to overlap
+        if (!batch_rows || capacity < 2) throw InvalidArgumentException("Invalid prefetch batch size or capacity");
+        _ring.reset(new Batch[capacity]);
+        const MYSQL_FIELD* fields = res.fetch_fields();
+        _unsigned.resize(_fields);
+        for (idx_t col = 0; col < _fields; ++col)
+            _unsigned[col] = fields[col].flags & UNSIGNED_FLAG;
+        _columns.assign(fields, _fields);
+        _reader = std::thread(&PrefetchResult::read, this);
+    }
+
+    PrefetchResult::~PrefetchResult() {
+        _stop.store(true);
+        // Wakes reader waiting for free slot, it checks _stop first
+        _head.fetch_add(1);
+        _head.notify_one();
+        _reader.join();
+    }
+
+    bool PrefetchResult::next() {
+        if (_batch) {
+            if (_row + 1 < _batch->rows) {
+                ++_row;
+                _cell += _fields;
+                return true;
+            }
+            if (_batch->last) return finish();
+            // Hands consumed batch back to reader
+            _head.store(_head.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+            _head.notify_one();
+        }
+        const size_t head = _head.load(std::memory_order_relaxed);
+        size_t tail;
+        while ((tail = _tail.load(std::memory_order_acquire)) == head)
+            _tail.wait(tail, std::memory_order_acquire);
+        _batch = &_ring[head % _capacity];
+        _row = 0;
+        _cell = 0;
+        return _batch->rows ? true : finish();
+    }
+
+    // Stays past the last row; read error is thrown once
+    bool PrefetchResult::finish() {
+        _row = _batch->rows;
+        if (_error) std::rethrow_exception(std::exchange(_error, nullptr));
+        return false;
+    }
+
+    // Reader thread
+    void PrefetchResult::read() {
+        scoped_thread_init thread_init;
+        for (size_t tail = 0;; ++tail) {
+            size_t head;
+            while (tail - (head = _head.load(std::memory_order_acquire)) == _capacity) {
+                if (_stop.load()) return;
+                _head.wait(head, std::memory_order_acquire);
+            }
+            if (_stop.load()) return;
+            // Storage of recycled batch is reused
+            Batch& batch = _ring[tail % _capacity];
+            batch.data.clear();
+            batch.offsets.clear();
+            batch.lengths.clear();
+            batch.rows = 0;
+            batch.last = false;
+            try {
+                while (batch.rows < _batch_rows && !_stop.load(std::memory_order_relaxed))
+                    if (!fill(batch)) {
+                        batch.last = true;
+                        break;
+                    }
+            } catch (...) {
+                _error = std::current_exception();
+                batch.last = true;
+            }
+            _tail.store(tail + 1, std::memory_order_release);
+            _tail.notify_one();
+            if (batch.last) return;
+        }
+    }
+
+    bool PrefetchResult::fill(Batch& batch) {
+        const MYSQL_ROW row = _res.fetch_row();
+        if (!row) return false;
+        const unsigned long* lengths = _res.fetch_lengths();
+        for (idx_t col = 0; col < _fields; ++col) {
+            batch.lengths.push_back(lengths[col]);
+            if (!row[col]) {
+                batch.offsets.push_back(NPOS);
+                continue;
+            }
+            batch.offsets.push_back(batch.data.size());
+            batch.data.insert(batch.data.end(), row[col], row[col] + lengths[col]);
+            batch.data.push_back('\0');
+        }
+        ++batch.rows;
+        return true;
+    }
+
+    ColumnRef PrefetchResult::column(std::string_view name) const {
+        const int col = _columns.find(name);
+        if (col < 0) throw mariadb_error("unknown column name \"" + std::string(name) + "\".");
+        return ColumnRef{static_cast<idx_t>(col)};
+    }
+
+    int32_t PrefetchResult::getInt(idx_t col) const {
+        const std::string_view data = getStringView(col);
+        return from_chars<int32_t>(data.data(), data.data() + data.size(), _unsigned[col]);
+    }
+
+    uint32_t PrefetchResult::getUInt(idx_t col) const {
+        const std::string_view data = getStringView(col);
+        return from_chars<uint32_t>(data.data(), data.data() + data.size(), _unsigned[col]);
+    }
+
+    int64_t PrefetchResult::getInt64(idx_t col) const {
+        const std::string_view data = getStringView(col);
+        return from_chars<int64_t>(data.data(), data.data() + data.size(), _unsigned[col]);
+    }
+
+    uint64_t PrefetchResult::getUInt64(idx_t col) const {
+        const std::string_view data = getStringView(col);
+        return from_chars<uint64_t>(data.data(), data.data() + data.size(), _unsigned[col]);
+    }
+
+    float PrefetchResult::getFloat(idx_t col) const {
+        const std::string_view data = getStringView(col);
+        return from_chars<float>(data.data(), data.data() + data.size());
+    }
+
+    double PrefetchResult::getDouble(idx_t col) const {
+        const std::string_view data = getStringView(col);
+        return from_chars<double>(data.data(), data.data() + data.size());
+    }
+}
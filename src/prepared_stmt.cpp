@@ -22,14 +22,17 @@
 #include <mariacpp/resultset.hpp>
 #include <mariacpp/time.hpp>
 #include <mariacpp/bits/bind.hpp>
+#include <errmsg.h>
+#include <new>
 #include <memory>
 #include <vector>
 #include <algorithm>
+#include <limits>
 
 namespace MariaCpp {
 
     PreparedStatement::PreparedStatement(Connection& conn) : _conn(conn), _stmt(conn.stmt_init()), _params(), _results(), _truncated(),
-                                                             _bind_params(), _bind_results(true) {
+                                                             _bind_params(), _params_reset(), _bind_results(true), _prebind(), _bound_row() {
     }
 
     PreparedStatement::~PreparedStatement() {
@@ -42,7 +45,20 @@ namespace MariaCpp {
         auto err_str = error_str();
         auto err_no = errorno();
         auto state = sqlstate();
-        throw mariadb_error(err_str, err_no, state);
+        mariadb_error::raise(err_str, err_no, state);
+    }
+
+    // Error of C++ side step (e.g. binding) which has thrown in try_*()
+    mariadb_error_code PreparedStatement::caught_error() const noexcept {
+        try {
+            throw;
+        } catch (const std::bad_alloc&) {
+            return mariadb_error_code("Out of memory", CR_OUT_OF_MEMORY, "HY000");
+        } catch (...) {
+            if (errorno()) return error_code();
+            if (_conn.errorno()) return _conn.error_code();
+            return mariadb_error_code("Unknown error", CR_UNKNOWN_ERROR, "HY000");
+        }
     }
 
     void PreparedStatement::attr_get(enum enum_stmt_attr_type option, void* arg) const {
@@ -56,12 +72,13 @@ namespace MariaCpp {
     }
 
     void PreparedStatement::bind_param(MYSQL_BIND* bind) {
-        _bind_params = false; // Turn off C++ style binding
+        _bind_params = _params_reset = false; // Turn off C++ style binding
         if (mysql_stmt_bind_param(_stmt, bind)) throw_exception();
     }
 
     void PreparedStatement::bind_result(MYSQL_BIND* bind) {
         _bind_results = false; // Turn off C++ style binding
+        _bound_row = nullptr;
         if (mysql_stmt_bind_result(_stmt, bind)) throw_exception();
     }
 
@@ -75,6 +92,7 @@ namespace MariaCpp {
     void PreparedStatement::prepare(const std::string& sql) {
         assert(!_bind_params && !_params);
         if (mysql_stmt_prepare(_stmt, sql.data(), static_cast<unsigned long>(sql.size()))) throw_exception();
+        _params_reset = false;
         do_reset_bind();
     }
 
@@ -84,17 +102,21 @@ namespace MariaCpp {
         delete[] _params;
         delete[] _results;
         _params = _results = NULL;
+        _bound_row = nullptr;
     }
 
     void PreparedStatement::reset() {
         if (mysql_stmt_reset(_stmt)) throw_exception();
+        // Connector still refers to freed params until they are set again
+        _params_reset = _params && param_count();
         do_reset_bind();
     }
 
     void PreparedStatement::do_bind_params() {
+        if (_params_reset) throw InvalidArgumentException("Params have to be set again after reset()");
         assert(_bind_params && _params);
         _bind_params = false;
-        const size_t count = param_count();
+        const size_t count = _prebind ? _prebind : param_count();
         if (count) {
             std::vector<MYSQL_BIND> par(count);
             for (unsigned i = 0; i < count; ++i) par[i] = _params[i];
@@ -103,38 +125,60 @@ namespace MariaCpp {
     }
 
     void PreparedStatement::execute() {
-        if (_bind_params) do_bind_params();
-        if (mysql_stmt_execute(_stmt)) {
-            if (errorno() != ER_LOCK_DEADLOCK)
-                throw_exception();
-            execute();
-        }
+        if (_bind_params || _params_reset) do_bind_params();
+        for (unsigned attempt = 1; mysql_stmt_execute(_stmt); ++attempt)
+            if (!_conn._retry->retry(attempt, errorno())) throw_exception();
     }
 
-    void PreparedStatement::do_bind_results() {
-        assert(_bind_results && !_results);
-        _bind_results = false;
-        // We will depend on MYSQL_DATA_TRUNCATED status
+    // We will depend on MYSQL_DATA_TRUNCATED status
+    void PreparedStatement::report_truncation() {
         my_bool trunc = false;
 #   if 50700 <= MYSQL_VERSION_ID
         _conn.get_option(MYSQL_REPORT_DATA_TRUNCATION, &trunc);
 #   endif
         if (!trunc) _conn.options(MYSQL_REPORT_DATA_TRUNCATION, &(trunc = true));
+    }
+
+    void PreparedStatement::do_bind_results() {
+        assert(_bind_results && !_results);
+        _bind_results = false;
+        report_truncation();
         const size_t count = field_count();
         std::unique_ptr<ResultSet> rs(result_metadata());
         if (count && rs.get()) {
             _results = new Bind[count]();
             std::vector<MYSQL_BIND> par(count);
-            _col_names.resize(count);
             auto* fields = rs->fetch_fields();
-            for (unsigned i = 0; i < count; ++i) {
-                _col_names[i] = std::string(fields[i].name, fields[i].name_length);
+            _columns.assign(fields, static_cast<unsigned>(count));
+            for (unsigned i = 0; i < count; ++i)
                 par[i] = _results[i].init(&fields[i]);
-            }
             bind_result(par.data());
         }
     }
 
+    void PreparedStatement::initResultField(MYSQL_BIND& bind, bool is_unsigned, enum_field_types type, void* value,
+                                            unsigned long size, unsigned long* length, char* is_null) {
+        bind = MYSQL_BIND();
+        bind.buffer_type = type;
+        bind.buffer = value;
+        bind.buffer_length = size;
+        bind.is_unsigned = is_unsigned;
+        bind.length = length;
+        bind.is_null = reinterpret_cast<my_bool*>(is_null);
+    }
+
+    void PreparedStatement::bindResult(const void* row, MYSQL_BIND* binds, idx_t columns) {
+        if (columns != field_count())
+            throw InvalidArgumentException("Number of fields differs from field_count()");
+        report_truncation();
+        bind_result(binds);
+        // Bind buffers are not used any longer
+        delete[] _results;
+        _results = nullptr;
+        _bind_results = false;
+        _bound_row = row;
+    }
+
     void PreparedStatement::do_rebind_results() {
         // After fetch(), if data was truncated (ie. BIND.error),
         // we will increase buffer size and re-fetch truncated field again.
@@ -152,8 +196,17 @@ namespace MariaCpp {
         bind_result(&par[0]);
     }
 
+    void PreparedStatement::do_expire_views() {
+#   ifndef NDEBUG
+        if (!_results) return;
+        const size_t count = field_count();
+        for (unsigned i = 0; i < count; ++i) _results[i].expire_views();
+#   endif
+    }
+
     bool PreparedStatement::fetch() {
         if (_bind_results) do_bind_results();
+        do_expire_views();
         int res = mysql_stmt_fetch(_stmt);
         if (1 == res) throw_exception();
         if (MYSQL_NO_DATA == res) return false;
@@ -174,6 +227,52 @@ namespace MariaCpp {
         return 0 == res;
     }
 
+    expected<void> PreparedStatement::try_execute() noexcept {
+        if (_bind_params || _params_reset) {
+            try {
+                do_bind_params();
+            } catch (...) {
+                return std::unexpected(caught_error());
+            }
+        }
+        for (unsigned attempt = 1; mysql_stmt_execute(_stmt); ++attempt)
+            if (!_conn._retry->retry(attempt, errorno())) return std::unexpected(error_code());
+        return {};
+    }
+
+    expected<bool> PreparedStatement::try_fetch() noexcept {
+        if (_bind_results) {
+            try {
+                do_bind_results();
+            } catch (...) {
+                return std::unexpected(caught_error());
+            }
+        }
+        do_expire_views();
+        return try_fetched(mysql_stmt_fetch(_stmt));
+    }
+
+    // Result of mysql_stmt_fetch(), see fetch()
+    expected<bool> PreparedStatement::try_fetched(int ret) noexcept {
+        if (1 == ret) return std::unexpected(error_code());
+        if (MYSQL_NO_DATA == ret) return false;
+        _truncated = MYSQL_DATA_TRUNCATED & ret;
+        if (_truncated && _results) {
+            try {
+                do_rebind_results();
+            } catch (...) {
+                return std::unexpected(caught_error());
+            }
+        }
+        return true;
+    }
+
+    expected<bool> PreparedStatement::try_next_result() noexcept {
+        int res = mysql_stmt_next_result(_stmt);
+        if (0 < res) return std::unexpected(error_code());
+        return 0 == res;
+    }
+
     ResultSet* PreparedStatement::result_metadata() {
         MYSQL_RES* res = mysql_stmt_result_metadata(_stmt);
         if (!res && errorno()) throw_exception();
@@ -181,10 +280,11 @@ namespace MariaCpp {
     }
 
     Bind& PreparedStatement::param(idx_t col) {
-        const size_t count = param_count();
+        const size_t count = _prebind ? _prebind : param_count();
         if (!_params) {
             _params = new Bind[count]();
             _bind_params = true; // important when all default params set to null!
+            _params_reset = false;
         }
         assert(col < count);
         if (count <= col) throw InvalidArgumentException("Bind-param out of range");
@@ -199,6 +299,108 @@ namespace MariaCpp {
         return _results[col];
     }
 
+#ifdef MARIADB_VERSION_ID
+    void PreparedStatement::prebind_params(unsigned int count) {
+        assert(!_params);
+        attr_set(STMT_ATTR_PREBIND_PARAMS, &count);
+        _prebind = count;
+    }
+
+    void PreparedStatement::execute_direct(const std::string& sql) {
+        if (_bind_params || _params_reset) do_bind_params();
+        const int res = mariadb_stmt_execute_direct(_stmt, sql.data(), sql.size());
+        _prebind = 0; // statement is prepared now
+        if (res) throw_exception();
+    }
+
+    void PreparedStatement::setArray(idx_t col, const int8_t* values, const char* indicators) {
+        if (param(col).setArray(MYSQL_TYPE_TINY, false, values, nullptr, indicators)) _bind_params = true;
+    }
+
+    void PreparedStatement::setArray(idx_t col, const uint8_t* values, const char* indicators) {
+        if (param(col).setArray(MYSQL_TYPE_TINY, true, values, nullptr, indicators)) _bind_params = true;
+    }
+
+    void PreparedStatement::setArray(idx_t col, const int16_t* values, const char* indicators) {
+        if (param(col).setArray(MYSQL_TYPE_SHORT, false, values, nullptr, indicators)) _bind_params = true;
+    }
+
+    void PreparedStatement::setArray(idx_t col, const uint16_t* values, const char* indicators) {
+        if (param(col).setArray(MYSQL_TYPE_SHORT, true, values, nullptr, indicators)) _bind_params = true;
+    }
+
+    void PreparedStatement::setArray(idx_t col, const int32_t* values, const char* indicators) {
+        if (param(col).setArray(MYSQL_TYPE_LONG, false, values, nullptr, indicators)) _bind_params = true;
+    }
+
+    void PreparedStatement::setArray(idx_t col, const uint32_t* values, const char* indicators) {
+        if (param(col).setArray(MYSQL_TYPE_LONG, true, values, nullptr, indicators)) _bind_params = true;
+    }
+
+    void PreparedStatement::setArray(idx_t col, const int64_t* values, const char* indicators) {
+        if (param(col).setArray(MYSQL_TYPE_LONGLONG, false, values, nullptr, indicators)) _bind_params = true;
+    }
+
+    void PreparedStatement::setArray(idx_t col, const uint64_t* values, const char* indicators) {
+        if (param(col).setArray(MYSQL_TYPE_LONGLONG, true, values, nullptr, indicators)) _bind_params = true;
+    }
+
+    void PreparedStatement::setArray(idx_t col, const float* values, const char* indicators) {
+        if (param(col).setArray(MYSQL_TYPE_FLOAT, false, values, nullptr, indicators)) _bind_params = true;
+    }
+
+    void PreparedStatement::setArray(idx_t col, const double* values, const char* indicators) {
+        if (param(col).setArray(MYSQL_TYPE_DOUBLE, false, values, nullptr, indicators)) _bind_params = true;
+    }
+
+    void PreparedStatement::setArray(idx_t col, const char* const* values, const unsigned long* lengths, const char* indicators) {
+        // Row count is unknown here, so lengths can't be computed by strlen()
+        if (!lengths) throw InvalidArgumentException("setArray() of strings needs lengths");
+        if (param(col).setArray(MYSQL_TYPE_STRING, false, values, lengths, indicators)) _bind_params = true;
+    }
+
+    void PreparedStatement::setArray(idx_t col, const MYSQL_TIME* const* values, enum_field_types type, const char* indicators) {
+        if (param(col).setArray(type, false, values, nullptr, indicators)) _bind_params = true;
+    }
+
+    void PreparedStatement::executeBatch(unsigned int rows) {
+        if (!rows) return;
+        // Scalar would be read past its buffer
+        for (idx_t col = 0; col < param_count(); ++col)
+            if (!param(col).isArray()) throw InvalidArgumentException("Param is not bound with setArray()");
+        attr_set(STMT_ATTR_ARRAY_SIZE, &rows);
+        unsigned int single = 0;
+        try {
+            execute();
+        } catch (...) {
+            attr_set(STMT_ATTR_ARRAY_SIZE, &single);
+            throw;
+        }
+        attr_set(STMT_ATTR_ARRAY_SIZE, &single);
+    }
+
+    void PreparedStatement::setRowField(idx_t col, bool is_unsigned, enum_field_types type, const void* value,
+                                        const unsigned long* length, const char* indicator) {
+        if (param(col).setArray(type, is_unsigned, value, length, indicator)) _bind_params = true;
+    }
+
+    void PreparedStatement::executeRows(size_t row_size, size_t rows, idx_t columns) {
+        if (columns != param_count())
+            throw InvalidArgumentException("Number of fields differs from param_count()");
+        if (std::numeric_limits<unsigned int>::max() < rows)
+            throw InvalidArgumentException("Too many rows for single batch");
+        unsigned int size = static_cast<unsigned int>(row_size);
+        attr_set(STMT_ATTR_ROW_SIZE, &size);
+        try {
+            executeBatch(static_cast<unsigned int>(rows));
+        } catch (...) {
+            attr_set(STMT_ATTR_ROW_SIZE, &(size = 0));
+            throw;
+        }
+        attr_set(STMT_ATTR_ROW_SIZE, &(size = 0));
+    }
+#endif
+
     void PreparedStatement::setNull(idx_t col) {
         if (param(col).setNull()) _bind_params = true;
     }
@@ -283,6 +485,10 @@ namespace MariaCpp {
         return result(col).getString();
     }
 
+    std::string_view PreparedStatement::getStringView(idx_t col) const {
+        return result(col).getStringView();
+    }
+
     int32_t PreparedStatement::getInt(idx_t col) const {
         return result(col).getInt();
     }
@@ -323,67 +529,67 @@ namespace MariaCpp {
         return getDateTime(col);
     }
 
-    std::string PreparedStatement::getString(const std::string& col) const {
+    std::string PreparedStatement::getString(std::string_view col) const {
         return getString(getFieldIndexByName(col));
     }
 
-    int32_t PreparedStatement::getInt(const std::string& col) const {
+    std::string_view PreparedStatement::getStringView(std::string_view col) const {
+        return getStringView(getFieldIndexByName(col));
+    }
+
+    int32_t PreparedStatement::getInt(std::string_view col) const {
         return getInt(getFieldIndexByName(col));
     }
 
-    uint32_t PreparedStatement::getUInt(const std::string& col) const {
+    uint32_t PreparedStatement::getUInt(std::string_view col) const {
         return getUInt(getFieldIndexByName(col));
     }
 
-    int64_t PreparedStatement::getInt64(const std::string& col) const {
+    int64_t PreparedStatement::getInt64(std::string_view col) const {
         return getInt64(getFieldIndexByName(col));
     }
 
-    uint64_t PreparedStatement::getUInt64(const std::string& col) const {
+    uint64_t PreparedStatement::getUInt64(std::string_view col) const {
         return getUInt64(getFieldIndexByName(col));
     }
 
-    float PreparedStatement::getFloat(const std::string& col) const {
+    float PreparedStatement::getFloat(std::string_view col) const {
         return getFloat(getFieldIndexByName(col));
     }
 
-    double PreparedStatement::getDouble(const std::string& col) const {
+    double PreparedStatement::getDouble(std::string_view col) const {
         return getDouble(getFieldIndexByName(col));
     }
 
-    Time PreparedStatement::getDate(const std::string& col) const {
+    Time PreparedStatement::getDate(std::string_view col) const {
         return getDate(getFieldIndexByName(col));
     }
 
-    Time PreparedStatement::getDateTime(const std::string& col) const {
+    Time PreparedStatement::getDateTime(std::string_view col) const {
         return getDateTime(getFieldIndexByName(col));
     }
 
-    Time PreparedStatement::getTime(const std::string& col) const {
+    Time PreparedStatement::getTime(std::string_view col) const {
         return getTime(getFieldIndexByName(col));
     }
 
-    Time PreparedStatement::getTimeStamp(const std::string& col) const {
+    Time PreparedStatement::getTimeStamp(std::string_view col) const {
         return getTimeStamp(getFieldIndexByName(col));
     }
 
-	bool PreparedStatement::isNull(const std::string& col) const {
+	bool PreparedStatement::isNull(std::string_view col) const {
 		return isNull(getFieldIndexByName(col));
 	}
 
-    static bool lc_equals(const std::string& a, const std::string& b) {
-        return a.size() == b.size() && std::ranges::equal(a, b,
-                  [](const char c, const char d) {
-                      return tolower(c) == tolower(d);
-                  });
+    int PreparedStatement::getFieldIndexByName(std::string_view name) const {
+        const int col = _columns.find(name);
+        if (col < 0) throw mariadb_error("unknown column name \"" + std::string(name) + "\".");
+        return col;
     }
 
-    int PreparedStatement::getFieldIndexByName(const std::string& name) const {
-        for (int i = 0; i < _col_names.size(); ++i) {
-            if (lc_equals(name, _col_names[i]))
-                return i;
-        }
-        throw mariadb_error("unknown column name \"" + name + "\".");
+    ColumnRef PreparedStatement::column(std::string_view name) {
+        if (_bind_results) do_bind_results();
+        return ColumnRef{static_cast<idx_t>(getFieldIndexByName(name))};
     }
 
 #ifdef MARIADB_VERSION_ID
@@ -397,7 +603,7 @@ namespace MariaCpp {
 
     bool PreparedStatement::next_result_start() {
         assert(!_conn._async_status);
-        int ret;
+        int ret = 0;
         _conn._async_status = mysql_stmt_next_result_start(&ret, _stmt);
         if (!_conn._async_status && 0 < ret) throw_exception();
         return !ret;
@@ -405,7 +611,7 @@ namespace MariaCpp {
 
     bool PreparedStatement::next_result_cont(int status) {
         assert(async_status());
-        int ret;
+        int ret = 0;
         _conn._async_status = mysql_stmt_next_result_cont(&ret, _stmt, status);
         if (!_conn._async_status && 0 < ret) throw_exception();
         return !ret;
@@ -427,7 +633,7 @@ namespace MariaCpp {
 
     void PreparedStatement::execute_start() {
         assert(!_conn._async_status);
-        if (_bind_params) do_bind_params();
+        if (_bind_params || _params_reset) do_bind_params();
         int ret;
         _conn._async_status = mysql_stmt_execute_start(&ret, _stmt);
         if (!_conn._async_status && ret) throw_exception();
@@ -444,6 +650,7 @@ namespace MariaCpp {
         assert(!_conn._async_status);
         if (_bind_results) do_bind_results();
         int ret;
+        do_expire_views();
         _conn._async_status = mysql_stmt_fetch_start(&ret, _stmt);
         if (_conn._async_status) return false;
         if (1 == ret) throw_exception();
@@ -465,6 +672,69 @@ namespace MariaCpp {
         return true;
     }
 
+    expected<void> PreparedStatement::try_execute_start() noexcept {
+        assert(!_conn._async_status);
+        if (_bind_params || _params_reset) {
+            try {
+                do_bind_params();
+            } catch (...) {
+                return std::unexpected(caught_error());
+            }
+        }
+        int ret;
+        _conn._async_status = mysql_stmt_execute_start(&ret, _stmt);
+        if (!_conn._async_status && ret) return std::unexpected(error_code());
+        return {};
+    }
+
+    expected<void> PreparedStatement::try_execute_cont(int status) noexcept {
+        assert(_conn._async_status);
+        int ret;
+        _conn._async_status = mysql_stmt_execute_cont(&ret, _stmt, status);
+        if (!_conn._async_status && ret) return std::unexpected(error_code());
+        return {};
+    }
+
+    expected<bool> PreparedStatement::try_fetch_start() noexcept {
+        assert(!_conn._async_status);
+        if (_bind_results) {
+            try {
+                do_bind_results();
+            } catch (...) {
+                return std::unexpected(caught_error());
+            }
+        }
+        int ret;
+        do_expire_views();
+        _conn._async_status = mysql_stmt_fetch_start(&ret, _stmt);
+        if (_conn._async_status) return false;
+        return try_fetched(ret);
+    }
+
+    expected<bool> PreparedStatement::try_fetch_cont(int status) noexcept {
+        assert(_conn._async_status);
+        int ret;
+        _conn._async_status = mysql_stmt_fetch_cont(&ret, _stmt, status);
+        if (_conn._async_status) return false;
+        return try_fetched(ret);
+    }
+
+    expected<bool> PreparedStatement::try_next_result_start() noexcept {
+        assert(!_conn._async_status);
+        int ret = 0;
+        _conn._async_status = mysql_stmt_next_result_start(&ret, _stmt);
+        if (!_conn._async_status && 0 < ret) return std::unexpected(error_code());
+        return !ret;
+    }
+
+    expected<bool> PreparedStatement::try_next_result_cont(int status) noexcept {
+        assert(_conn._async_status);
+        int ret = 0;
+        _conn._async_status = mysql_stmt_next_result_cont(&ret, _stmt, status);
+        if (!_conn._async_status && 0 < ret) return std::unexpected(error_code());
+        return !ret;
+    }
+
     void PreparedStatement::store_result_start() {
         assert(!_conn._async_status);
         int ret;
@@ -541,5 +811,40 @@ namespace MariaCpp {
         if (!_conn._async_status && ret) throw_exception();
     }
 
+    Awaitable<bool> PreparedStatement::next_result_async() {
+        return Awaitable<bool>(_conn, [this] { return next_result_start(); },
+                               [this](int status) { return next_result_cont(status); });
+    }
+
+    Awaitable<void> PreparedStatement::prepare_async(std::string sql) {
+        return Awaitable<void>(_conn, [this, sql = std::move(sql)] { prepare_start(sql); },
+                               [this](int status) { prepare_cont(status); });
+    }
+
+    Awaitable<void> PreparedStatement::execute_async() {
+        return Awaitable<void>(_conn, [this] { execute_start(); },
+                               [this](int status) { execute_cont(status); });
+    }
+
+    Awaitable<bool> PreparedStatement::fetch_async() {
+        return Awaitable<bool>(_conn, [this] { return fetch_start(); },
+                               [this](int status) { return fetch_cont(status); });
+    }
+
+    Awaitable<void> PreparedStatement::store_result_async() {
+        return Awaitable<void>(_conn, [this] { store_result_start(); },
+                               [this](int status) { store_result_cont(status); });
+    }
+
+    Awaitable<void> PreparedStatement::reset_async() {
+        return Awaitable<void>(_conn, [this] { reset_start(); },
+                               [this](int status) { reset_cont(status); });
+    }
+
+    Awaitable<void> PreparedStatement::free_result_async() {
+        return Awaitable<void>(_conn, [this] { free_result_start(); },
+                               [this](int status) { free_result_cont(status); });
+    }
+
 #endif /* MARIADB_VERSION_ID */
 }
@@ -0,0 +1,209 @@
+/****************************************************************************
+  Copyright (C) 2015 Karol Roslaniec <mariacpp@roslaniec.net>
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not see <http://www.gnu.org/licenses>
+  or write to the Free Software Foundation, Inc.,
+  51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+*****************************************************************************/
+#include <mariacpp/reactor.hpp>
+#include <mariacpp/connection.hpp>
+#include <mariacpp/mariadb_error.hpp>
+#include <mariacpp/prepared_stmt.hpp>
+#include <mariacpp/resultset.hpp>
+#include <algorithm>
+#include <cassert>
+#include <cerrno>
+#include <chrono>
+#include <utility>
+#include <vector>
+#ifdef MARIADB_VERSION_ID
+#if defined(__linux__)
+#include <sys/epoll.h>
+#include <unistd.h>
+#elif defined(WIN32)
+#include <winsock2.h>
+#else
+#include <poll.h>
+#endif
+
+namespace MariaCpp {
+
+    Reactor::Reactor() : _timers(now_ms()), _epoll(-1) {
+#   ifdef __linux__
+        _epoll = epoll_create1(EPOLL_CLOEXEC);
+        if (_epoll < 0) throw mariadb_error("epoll_create1() failed");
+#   endif
+    }
+
+    uint64_t Reactor::now_ms() {
+        using namespace std::chrono;
+        return duration_cast<milliseconds>(steady_clock::now().time_since_epoch()).count();
+    }
+
+    Reactor::~Reactor() {
+        assert(_watches.empty());
+#   ifdef __linux__
+        close(_epoll);
+#   endif
+    }
+
+    void Reactor::submit(Connection& conn, Continuation cont, Completion done) {
+        if (!conn.async_status()) {
+            if (done) done(nullptr);
+            return;
+        }
+        auto res = _watches.try_emplace(&conn);
+        if (!res.second)
+            throw InvalidArgumentException("Connection has already pending operation");
+        Watch& watch = res.first->second;
+        watch.conn = &conn;
+        watch.cont = std::move(cont);
+        watch.done = std::move(done);
+        watch.ready = 0;
+        try {
+            arm(watch);
+        } catch (...) {
+            _watches.erase(res.first);
+            throw;
+        }
+    }
+
+    void Reactor::submit(PreparedStatement& stmt, Continuation cont, Completion done) {
+        return submit(stmt.connection(), std::move(cont), std::move(done));
+    }
+
+    void Reactor::submit(ResultSet& res, Continuation cont, Completion done) {
+        return submit(res.connection(), std::move(cont), std::move(done));
+    }
+
+    // (Re)registers interest in events the operation is waiting for
+    void Reactor::arm(Watch& watch) {
+        Connection& conn = *watch.conn;
+        const int status = conn.async_status();
+        if (status & MYSQL_WAIT_TIMEOUT)
+            _timers.schedule(watch, now_ms() + conn.get_timeout_value_ms());
+        else _timers.cancel(watch);
+#   ifdef __linux__
+        struct epoll_event ev = {};
+        ev.events = static_cast<uint32_t>(EPOLLONESHOT)
+                    | (status & MYSQL_WAIT_READ ? static_cast<uint32_t>(EPOLLIN) : 0)
+                    | (status & MYSQL_WAIT_WRITE ? static_cast<uint32_t>(EPOLLOUT) : 0)
+                    | (status & MYSQL_WAIT_EXCEPT ? static_cast<uint32_t>(EPOLLPRI) : 0);
+        ev.data.ptr = &conn;
+        // Sockets stay registered between operations (one-shot disarms
+        // them), closed sockets are dropped from epoll set by kernel.
+        const int fd = conn.get_socket();
+        if (!epoll_ctl(_epoll, EPOLL_CTL_MOD, fd, &ev)) return;
+        if (errno == ENOENT && !epoll_ctl(_epoll, EPOLL_CTL_ADD, fd, &ev)) return;
+        throw mariadb_error("epoll_ctl() failed");
+#   endif
+    }
+
+    // Socket event takes precedence over timeout expired at the same time
+    void Reactor::ready(Watch& watch, int status) {
+        if (!watch.ready) _ready.push_back(watch.conn);
+        if (status != MYSQL_WAIT_TIMEOUT) watch.ready = (watch.ready & ~MYSQL_WAIT_TIMEOUT) | status;
+        else if (!watch.ready) watch.ready = status;
+    }
+
+    void Reactor::dispatch(Connection* conn) {
+        auto it = _watches.find(conn);
+        if (it == _watches.end()) return; // finished meanwhile
+        Watch& watch = it->second;
+        const int status = std::exchange(watch.ready, 0);
+        if (!status) return; // resubmitted meanwhile
+        try {
+            watch.cont(status);
+        } catch (...) {
+            return finish(watch, std::current_exception());
+        }
+        if (conn->async_status()) {
+            try {
+                arm(watch);
+            } catch (...) {
+                finish(watch, std::current_exception());
+            }
+        } else finish(watch, nullptr);
+    }
+
+    void Reactor::finish(Watch& watch, std::exception_ptr error) {
+        _timers.cancel(watch);
+        Completion done = std::move(watch.done);
+        _watches.erase(watch.conn);
+        // done() may already submit next operation
+        if (done) done(error);
+    }
+
+    size_t Reactor::run_once(int timeout_ms) {
+        int64_t next = _timers.next_timeout();
+        if (0 <= next) {
+            next = std::max<int64_t>(0, next - static_cast<int64_t>(now_ms() - _timers.now()));
+            if (timeout_ms < 0 || next < timeout_ms) timeout_ms = static_cast<int>(next);
+        }
+
+        _ready.clear();
+#   ifdef __linux__
+        struct epoll_event events[64];
+        const int count = epoll_wait(_epoll, events, 64, timeout_ms);
+        if (count < 0 && errno != EINTR) throw mariadb_error("epoll_wait() failed");
+        for (int i = 0; i < count; ++i) {
+            auto it = _watches.find(static_cast<Connection*>(events[i].data.ptr));
+            if (it == _watches.end()) continue;
+            const uint32_t ev = events[i].events;
+            int status = (ev & EPOLLIN ? MYSQL_WAIT_READ : 0)
+                         | (ev & EPOLLOUT ? MYSQL_WAIT_WRITE : 0)
+                         | (ev & EPOLLPRI ? MYSQL_WAIT_EXCEPT : 0);
+            if (ev & (EPOLLERR | EPOLLHUP)) status |= MYSQL_WAIT_READ | MYSQL_WAIT_WRITE;
+            ready(it->second, status);
+        }
+#   else
+        std::vector<struct pollfd> pfds;
+        std::vector<Watch*> watches;
+        for (auto& w: _watches) {
+            const int status = w.first->async_status();
+            struct pollfd pfd = {};
+            pfd.fd = w.first->get_socket();
+            pfd.events = (status & MYSQL_WAIT_READ ? POLLIN : 0)
+                         | (status & MYSQL_WAIT_WRITE ? POLLOUT : 0)
+                         | (status & MYSQL_WAIT_EXCEPT ? POLLPRI : 0);
+            pfds.push_back(pfd);
+            watches.push_back(&w.second);
+        }
+#       ifdef WIN32
+        const int count = WSAPoll(pfds.data(), static_cast<ULONG>(pfds.size()), timeout_ms);
+#       else
+        const int count = poll(pfds.data(), pfds.size(), timeout_ms);
+#       endif
+        if (count < 0 && errno != EINTR) throw mariadb_error("poll() failed");
+        for (size_t i = 0; 0 < count && i < pfds.size(); ++i) {
+            const int ev = pfds[i].revents;
+            if (!ev) continue;
+            int status = (ev & POLLIN ? MYSQL_WAIT_READ : 0)
+                         | (ev & POLLOUT ? MYSQL_WAIT_WRITE : 0)
+                         | (ev & POLLPRI ? MYSQL_WAIT_EXCEPT : 0);
+            if (ev & (POLLERR | POLLHUP)) status |= MYSQL_WAIT_READ | MYSQL_WAIT_WRITE;
+            ready(*watches[i], status);
+        }
+#   endif
+
+        _timers.advance(now_ms(), [this](TimerWheel::Timer& timer) {
+            ready(static_cast<Watch&>(timer), MYSQL_WAIT_TIMEOUT);
+        });
+
+        for (Connection* conn: _ready) dispatch(conn);
+        return _ready.size();
+    }
+}
+
+#endif /* MARIADB_VERSION_ID */
@@ -19,7 +19,8 @@
 #include <mariacpp/resultset.hpp>
 #include <mariacpp/connection.hpp>
 #include <mariacpp/mariadb_error.hpp>
-#include <cstdlib>
+#include <mariacpp/time.hpp>
+#include <mariacpp/bits/parse.hpp>
 #include <algorithm>
 
 namespace MariaCpp {
@@ -31,6 +32,13 @@ namespace MariaCpp {
         return _row;
     }
 
+    expected<bool> ResultSet::try_next() noexcept {
+        _lengths = nullptr;
+        _row = mysql_fetch_row(_res);
+        if (!_row && _conn.errorno()) return std::unexpected(_conn.error_code());
+        return _row != nullptr;
+    }
+
     std::string ResultSet::getString(idx_t col) const {
         assert_col(col);
         const char* data = _row[col];
@@ -41,46 +49,75 @@ namespace MariaCpp {
 
     int32_t ResultSet::getInt(idx_t col) const {
         assert_col(col);
-        if (isNull(col)) return 0;
-        if (fetch_field_direct(col)->flags & UNSIGNED_FLAG)
-            return strtoul(_row[col], NULL, 10);
-        return strtol(_row[col], NULL, 10);
+        const char* data = _row[col];
+        if (!data) return 0;
+        return from_chars<int32_t>(data, data + length(col), is_unsigned(col));
     }
 
     int64_t ResultSet::getInt64(idx_t col) const {
         assert_col(col);
-        if (isNull(col)) return 0;
-        if (fetch_field_direct(col)->flags & UNSIGNED_FLAG)
-            return strtoull(_row[col], NULL, 10);
-        return strtoll(_row[col], NULL, 10);
+        const char* data = _row[col];
+        if (!data) return 0;
+        return from_chars<int64_t>(data, data + length(col), is_unsigned(col));
     }
 
     uint32_t ResultSet::getUInt(idx_t col) const {
         assert_col(col);
-        if (isNull(col)) return 0;
-        if (fetch_field_direct(col)->flags & UNSIGNED_FLAG)
-            return strtoul(_row[col], NULL, 10);
-        return strtol(_row[col], NULL, 10);
+        const char* data = _row[col];
+        if (!data) return 0;
+        return from_chars<uint32_t>(data, data + length(col), is_unsigned(col));
     }
 
     uint64_t ResultSet::getUInt64(idx_t col) const {
         assert_col(col);
-        if (isNull(col)) return 0;
-        if (fetch_field_direct(col)->flags & UNSIGNED_FLAG)
-            return strtoull(_row[col], NULL, 10);
-        return strtoll(_row[col], NULL, 10);
+        const char* data = _row[col];
+        if (!data) return 0;
+        return from_chars<uint64_t>(data, data + length(col), is_unsigned(col));
     }
 
     float ResultSet::getFloat(idx_t col) const {
         assert_col(col);
-        if (isNull(col)) return 0;
-        return strtof(_row[col], NULL);
+        const char* data = _row[col];
+        if (!data) return 0;
+        return from_chars<float>(data, data + length(col));
     }
 
     double ResultSet::getDouble(idx_t col) const {
         assert_col(col);
-        if (isNull(col)) return 0;
-        return strtod(_row[col], NULL);
+        const char* data = _row[col];
+        if (!data) return 0;
+        return from_chars<double>(data, data + length(col));
+    }
+
+    Time ResultSet::getDate(idx_t col) const {
+        return getDateTime(col);
+    }
+
+    Time ResultSet::getDateTime(idx_t col) const {
+        assert_col(col);
+        const char* data = _row[col];
+        if (!data) return Time::none();
+        return Time(std::string(data, length(col)));
+    }
+
+    Time ResultSet::getTime(idx_t col) const {
+        return getDateTime(col);
+    }
+
+    Time ResultSet::getTimeStamp(idx_t col) const {
+        return getDateTime(col);
+    }
+
+    // Column table is built once per result, not on each getter call
+    bool ResultSet::is_unsigned(idx_t col) const {
+        if (_unsigned.empty()) {
+            const unsigned count = num_fields();
+            const MYSQL_FIELD* fields = fetch_fields();
+            _unsigned.resize(count);
+            for (unsigned i = 0; i < count; ++i)
+                _unsigned[i] = fields[i].flags & UNSIGNED_FLAG;
+        }
+        return _unsigned[col];
     }
 
 #ifdef MARIADB_VERSION_ID
@@ -118,59 +155,95 @@ namespace MariaCpp {
         return _row;
     }
 
+    expected<bool> ResultSet::try_next_start() noexcept {
+        assert(!_conn._async_status);
+        _lengths = nullptr;
+        _conn._async_status = mysql_fetch_row_start(&_row, _res);
+        if (_conn._async_status) return false;
+        if (!_row && _conn.errorno()) return std::unexpected(_conn.error_code());
+        return _row != nullptr;
+    }
+
+    expected<bool> ResultSet::try_next_cont(int status) noexcept {
+        assert(_conn._async_status);
+        _conn._async_status = mysql_fetch_row_cont(&_row, _res, status);
+        if (_conn._async_status) return false;
+        if (!_row && _conn.errorno()) return std::unexpected(_conn.error_code());
+        return _row != nullptr;
+    }
+
+    Awaitable<void> ResultSet::free_result_async() {
+        return Awaitable<void>(_conn, [this] { free_result_start(); },
+                               [this](int status) { free_result_cont(status); });
+    }
+
+    Awaitable<bool> ResultSet::next_async() {
+        return Awaitable<bool>(_conn, [this] { return next_start(); },
+                               [this](int status) { return next_cont(status); });
+    }
+
+#endif /* MARIADB_VERSION_ID */
+
     void ResultSet::fetchFieldNames() {
-        _col_names.resize(_res->field_count);
-        auto* fields = fetch_fields();
-        for (unsigned int i = 0; i < _res->field_count; ++i) {
-            _col_names[i] = std::string(fields[i].name, fields[i].name_length);
-        }
+        _columns.assign(fetch_fields(), num_fields());
     }
 
-	bool ResultSet::isNull(const std::string& col) const {
+	bool ResultSet::isNull(std::string_view col) const {
 		return isNull(getFieldIndexByName(col));
 	}
 
-    std::string ResultSet::getString(const std::string& col) const {
+    std::string ResultSet::getString(std::string_view col) const {
         return getString(getFieldIndexByName(col));
     }
 
-    int32_t ResultSet::getInt(const std::string& col) const {
+    std::string_view ResultSet::getStringView(std::string_view col) const {
+        return getStringView(getFieldIndexByName(col));
+    }
+
+    int32_t ResultSet::getInt(std::string_view col) const {
         return getInt(getFieldIndexByName(col));
     }
 
-    int64_t ResultSet::getInt64(const std::string& col) const {
+    int64_t ResultSet::getInt64(std::string_view col) const {
         return getInt64(getFieldIndexByName(col));
     }
 
-    uint32_t ResultSet::getUInt(const std::string& col) const {
+    uint32_t ResultSet::getUInt(std::string_view col) const {
         return getUInt(getFieldIndexByName(col));
     }
 
-    uint64_t ResultSet::getUInt64(const std::string& col) const {
+    uint64_t ResultSet::getUInt64(std::string_view col) const {
         return getUInt64(getFieldIndexByName(col));
     }
 
-    float ResultSet::getFloat(const std::string& col) const {
+    float ResultSet::getFloat(std::string_view col) const {
         return getFloat(getFieldIndexByName(col));
     }
 
-    double ResultSet::getDouble(const std::string& col) const {
+    double ResultSet::getDouble(std::string_view col) const {
         return getDouble(getFieldIndexByName(col));
     }
 
-    static bool lc_equals(const std::string& a, const std::string& b) {
-        return a.size() == b.size() && std::ranges::equal(a, b,
-                  [](const char c, const char d) {
-                      return tolower(c) == tolower(d);
-                  });
+    Time ResultSet::getDate(std::string_view col) const {
+        return getDate(getFieldIndexByName(col));
     }
 
-    int ResultSet::getFieldIndexByName(const std::string& name) const {
-        for (int i = 0; i < _col_names.size(); ++i) {
-            if (lc_equals(name, _col_names[i]))
-                return i;
-        }
-        throw mariadb_error("unknown column name \"" + name + "\", did you forget to call \"fetchFieldNames()\"?");
+    Time ResultSet::getDateTime(std::string_view col) const {
+        return getDateTime(getFieldIndexByName(col));
+    }
+
+    Time ResultSet::getTime(std::string_view col) const {
+        return getTime(getFieldIndexByName(col));
+    }
+
+    Time ResultSet::getTimeStamp(std::string_view col) const {
+        return getTimeStamp(getFieldIndexByName(col));
+    }
+
+    int ResultSet::getFieldIndexByName(std::string_view name) const {
+        if (_columns.empty()) _columns.assign(fetch_fields(), num_fields());
+        const int col = _columns.find(name);
+        if (col < 0) throw mariadb_error("unknown column name \"" + std::string(name) + "\".");
+        return col;
     }
-#endif /* MARIADB_VERSION_ID */
 }
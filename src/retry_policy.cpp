@@ -0,0 +1,68 @@
+/****************************************************************************
+  Copyright (C) 2015 Karol Roslaniec <mariacpp@roslaniec.net>
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not see <http://www.gnu.org/licenses>
+  or write to the Free Software Foundation, Inc.,
+  51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+*****************************************************************************/
+#include <mariacpp/retry_policy.hpp>
+#include <mysqld_error.h>
+#include <algorithm>
+#include <random>
+#include <thread>
+
+namespace MariaCpp {
+
+    RetryPolicy::RetryPolicy()
+            : _max_attempts(5), _base_delay(2), _max_delay(200),
+              _retryable{ER_LOCK_DEADLOCK, ER_LOCK_WAIT_TIMEOUT}, _retries(0), _exhausted(0) {}
+
+    RetryPolicy& RetryPolicy::defaults() {
+        static RetryPolicy policy;
+        return policy;
+    }
+
+    // random_device may throw if no entropy source is available
+    static unsigned random_seed() noexcept {
+        try {
+            return std::random_device{}();
+        } catch (...) {
+            return static_cast<unsigned>(std::chrono::steady_clock::now().time_since_epoch().count());
+        }
+    }
+
+    bool RetryPolicy::retry(unsigned attempt, unsigned err_no) noexcept {
+        if (!retryable(err_no)) return false;
+        if (_max_attempts <= attempt) {
+            _exhausted.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+
+        // Full jitter spreads retries of colliding transactions
+        const unsigned shift = std::min(attempt - 1, 20u);
+        const duration::rep cap = std::min(_max_delay.count(), _base_delay.count() << shift);
+        static thread_local std::minstd_rand rng(random_seed());
+        const duration delay(cap <= 0 ? 0 : std::uniform_int_distribution<duration::rep>(0, cap)(rng));
+
+        // Called from noexcept try_* paths, so exception is dropped
+        if (_on_retry) {
+            try {
+                _on_retry(attempt, err_no, delay);
+            } catch (...) {}
+        }
+        _retries.fetch_add(1, std::memory_order_relaxed);
+        if (delay.count()) std::this_thread::sleep_for(delay);
+        return true;
+    }
+}
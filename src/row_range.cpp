@@ -0,0 +1,79 @@
+/****************************************************************************
+  Copyright (C) 2015 Karol Roslaniec <mariacpp@roslaniec.net>
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not see <http://www.gnu.org/licenses>
+  or write to the Free Software Foundation, Inc.,
+  51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+*****************************************************************************/
+#include <mariacpp/bits/row_range.hpp>
+#include <mariacpp/bits/bind.hpp>
+#include <mariacpp/mariadb_error.hpp>
+#include <mariacpp/prepared_stmt.hpp>
+#include <mariacpp/resultset.hpp>
+#include <memory>
+#include <string>
+
+namespace MariaCpp {
+
+    static bool is_temporal(enum_field_types type) {
+        switch (type) {
+            case MYSQL_TYPE_TIMESTAMP:
+            case MYSQL_TYPE_DATE:
+            case MYSQL_TYPE_TIME:
+            case MYSQL_TYPE_DATETIME:
+            case MYSQL_TYPE_NEWDATE:
+                return true;
+            default:
+                return false;
+        }
+    }
+
+    static void check_columns(const MYSQL_FIELD* fields, unsigned int num_fields,
+                              const column_kind* kinds, unsigned int count, bool binary) {
+        if (num_fields != count)
+            throw InvalidArgumentException("rows<...>(): result has " + std::to_string(num_fields)
+                                           + " columns, not " + std::to_string(count));
+        for (unsigned int i = 0; i < count; ++i) {
+            const enum_field_types type = fields[i].type;
+            if (MYSQL_TYPE_NULL == type) continue;
+            const char* expected = nullptr;
+            switch (kinds[i]) {
+                case COLUMN_NUMBER:
+                    if (is_temporal(type) || MYSQL_TYPE_GEOMETRY == type) expected = "number";
+                    break;
+                case COLUMN_STRING:
+                    break;
+                case COLUMN_STRING_VIEW:
+                    if (binary && !Bind::isStringType(type)) expected = "string_view";
+                    break;
+                case COLUMN_TIME:
+                    if (!is_temporal(type)) expected = "Time";
+                    break;
+            }
+            if (expected)
+                throw InvalidArgumentException("rows<...>(): column \"" + std::string(fields[i].name, fields[i].name_length)
+                                               + "\" can't be read as " + expected);
+        }
+    }
+
+    void check_columns(ResultSet& res, const column_kind* kinds, unsigned int count) {
+        check_columns(res.fetch_fields(), res.num_fields(), kinds, count, false);
+    }
+
+    void check_columns(PreparedStatement& stmt, const column_kind* kinds, unsigned int count) {
+        std::unique_ptr<ResultSet> meta(stmt.result_metadata());
+        if (!meta) return check_columns(nullptr, 0, kinds, count, true);
+        check_columns(meta->fetch_fields(), meta->num_fields(), kinds, count, true);
+    }
+}
@@ -0,0 +1,144 @@
+/****************************************************************************
+  Copyright (C) 2015 Karol Roslaniec <mariacpp@roslaniec.net>
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not see <http://www.gnu.org/licenses>
+  or write to the Free Software Foundation, Inc.,
+  51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+*****************************************************************************/
+#include <mariacpp/statement_cache.hpp>
+#include <mariacpp/connection.hpp>
+#include <mariacpp/mariadb_error.hpp>
+#include <mariacpp/prepared_stmt.hpp>
+#include <algorithm>
+#include <cassert>
+#include <utility>
+
+namespace MariaCpp {
+
+    StatementCache::StatementCache(Connection& conn, size_t capacity)
+            : _conn(conn), _capacity(capacity) {}
+
+    StatementCache::~StatementCache() {
+        assert(_stale.empty());
+        assert(std::none_of(_lru.begin(), _lru.end(), [](const Entry& e) { return e.leased; }));
+    }
+
+    PreparedStatement* StatementCache::prepare(const std::string& sql) {
+        Connection::ReadOnly ro(_conn); // cached statements don't make it dirty()
+        std::unique_ptr<PreparedStatement> stmt;
+        for (;;) {
+            try {
+                stmt.reset(new PreparedStatement(_conn));
+                stmt->prepare(sql);
+                break;
+            } catch (mariadb_error& e) {
+                if (e.errorno() != ER_MAX_PREPARED_STMT_COUNT_REACHED) throw;
+                stmt.reset();
+                if (!evict_one()) throw;
+                _capacity = std::max<size_t>(_lru.size(), 1);
+            }
+        }
+        return stmt.release();
+    }
+
+    // Closes least recently used idle statement
+    bool StatementCache::evict_one() {
+        for (auto it = _lru.rbegin(); it != _lru.rend(); ++it) {
+            if (it->leased) continue;
+            _index.erase(it->sql);
+            _lru.erase(std::next(it).base());
+            return true;
+        }
+        return false;
+    }
+
+    StatementCache::Lease StatementCache::acquire(const std::string& sql) {
+        auto found = _index.find(sql);
+        if (found != _index.end()) {
+            Entry& entry = *found->second;
+            if (entry.leased) // in use, hand out private statement
+                return Lease(this, nullptr, prepare(sql));
+            _lru.splice(_lru.begin(), _lru, found->second);
+            entry.leased = true;
+            return Lease(this, &entry, entry.stmt.get());
+        }
+
+        std::unique_ptr<PreparedStatement> stmt(prepare(sql));
+        while (_capacity <= _lru.size() && evict_one());
+        if (_capacity <= _lru.size()) // all cached statements are leased
+            return Lease(this, nullptr, stmt.release());
+        _lru.push_front(Entry{sql, std::move(stmt), true, false});
+        Entry& entry = _lru.front();
+        _index.emplace(entry.sql, _lru.begin());
+        return Lease(this, &entry, entry.stmt.get());
+    }
+
+    void StatementCache::clear() {
+        _index.clear();
+        for (auto it = _lru.begin(); it != _lru.end();) {
+            if (it->leased) {
+                it->stale = true;
+                _stale.splice(_stale.end(), _lru, it++);
+            } else it = _lru.erase(it);
+        }
+    }
+
+    void StatementCache::release(Entry* entry, PreparedStatement* stmt) noexcept {
+        if (!entry) {
+            delete stmt;
+            return;
+        }
+        entry->leased = false;
+        if (entry->stale) {
+            _stale.remove_if([entry](const Entry& e) { return &e == entry; });
+            return;
+        }
+        try {
+            // Frees unread rows (they would block the next execute()),
+            // long data and params, so next lease starts clean
+            stmt->reset();
+        } catch (mariadb_error&) {
+            _index.erase(entry->sql);
+            _lru.remove_if([entry](const Entry& e) { return &e == entry; });
+        }
+        // Capacity lowered while leased
+        while (_capacity < _lru.size() && evict_one());
+    }
+
+    void StatementCache::set_capacity(size_t capacity) {
+        _capacity = capacity;
+        while (_capacity < _lru.size() && evict_one());
+    }
+
+    StatementCache::Lease::Lease(Lease&& other) noexcept
+            : _cache(std::exchange(other._cache, nullptr)), _entry(std::exchange(other._entry, nullptr)),
+              _stmt(std::exchange(other._stmt, nullptr)) {}
+
+    StatementCache::Lease& StatementCache::Lease::operator=(Lease&& other) noexcept {
+        if (this != &other) {
+            release();
+            _cache = std::exchange(other._cache, nullptr);
+            _entry = std::exchange(other._entry, nullptr);
+            _stmt = std::exchange(other._stmt, nullptr);
+        }
+        return *this;
+    }
+
+    void StatementCache::Lease::release() noexcept {
+        if (_stmt) _cache->release(_entry, _stmt);
+        _cache = nullptr;
+        _entry = nullptr;
+        _stmt = nullptr;
+    }
+}
@@ -0,0 +1,115 @@
+/****************************************************************************
+  Copyright (C) 2015 Karol Roslaniec <mariacpp@roslaniec.net>
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not see <http://www.gnu.org/licenses>
+  or write to the Free Software Foundation, Inc.,
+  51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+*****************************************************************************/
+#define _CRT_SECURE_NO_WARNINGS
+#include <mariacpp/lib.hpp>
+#include <mariacpp/async.hpp>
+#include <mariacpp/connection.hpp>
+#include <mariacpp/mariadb_error.hpp>
+#include <mariacpp/prepared_stmt.hpp>
+#include <mariacpp/reactor.hpp>
+#include <mariacpp/resultset.hpp>
+#include <mariacpp/uri.hpp>
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#ifdef MARIADB_VERSION_ID
+int err_count = 0;
+
+MariaCpp::Task<int> select_value(MariaCpp::Connection& conn, int value) {
+    co_await conn.query_async("SELECT SLEEP(0.2), " + std::to_string(value));
+    std::unique_ptr<MariaCpp::ResultSet> res(co_await conn.store_result_async());
+    int result = -1;
+    while (co_await res->next_async())
+        result = res->getInt(1);
+    co_return result;
+}
+
+MariaCpp::Task<> client(const MariaCpp::Uri& uri, const char* user, const char* passwd, int id) {
+    MariaCpp::Connection conn;
+    conn.options(MYSQL_OPT_NONBLOCK, nullptr);
+    co_await conn.connect_async(uri, user, passwd);
+    if (co_await select_value(conn, id) != id) {
+        std::cerr << "Unexpected result of query " << id << std::endl;
+        ++err_count;
+    }
+
+    std::unique_ptr<MariaCpp::PreparedStatement> stmt(new MariaCpp::PreparedStatement(conn));
+    co_await stmt->prepare_async("SELECT ? + 1");
+    stmt->setInt(0, id);
+    co_await stmt->execute_async();
+    if (!co_await stmt->fetch_async() || stmt->getInt(0) != id + 1) {
+        std::cerr << "Unexpected result of statement " << id << std::endl;
+        ++err_count;
+    }
+    co_await stmt->free_result_async();
+}
+
+void done(std::exception_ptr error) {
+    if (!error) return;
+    ++err_count;
+    try {
+        std::rethrow_exception(error);
+    } catch (MariaCpp::mariadb_error& e) {
+        std::cerr << e << std::endl;
+    }
+}
+#endif
+
+int test(const char* uri, const char* user, const char* passwd) {
+    std::clog << "DB uri: " << uri << std::endl;
+    std::clog << "DB user: " << user << std::endl;
+    std::clog << "DB passwd: " << passwd << std::endl;
+
+#   ifdef MARIADB_VERSION_ID
+    try {
+        const MariaCpp::Uri db_uri(uri);
+
+        // Without scheduler operations block in async_wait()
+        MariaCpp::spawn(client(db_uri, user, passwd, -1), done);
+
+        // Many coroutines multiplexed on one thread
+        MariaCpp::Reactor reactor;
+        MariaCpp::scoped_scheduler sched(reactor);
+        for (int i = 0; i < 32; ++i)
+            MariaCpp::spawn(client(db_uri, user, passwd, i), done);
+        reactor.run();
+    } catch (MariaCpp::mariadb_error& e) {
+        std::cerr << e << std::endl;
+        return 1;
+    }
+#   endif
+    return err_count;
+}
+
+int main() {
+    MariaCpp::scoped_library_init maria_lib_init;
+
+    const char* uri = std::getenv("TEST_DB_URI");
+    const char* user = std::getenv("TEST_DB_USER");
+    const char* passwd = std::getenv("TEST_DB_PASSWD");
+    if (!uri) uri = "tcp://localhost:3306/test";
+    if (!user) user = "test";
+    if (!passwd) passwd = "";
+
+    return test(uri, user, passwd);
+}
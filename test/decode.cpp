@@ -0,0 +1,135 @@
+/****************************************************************************
+  Copyright (C) 2015 Karol Roslaniec <mariacpp@roslaniec.net>
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not see <http://www.gnu.org/licenses>
+  or write to the Free Software Foundation, Inc.,
+  51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+*****************************************************************************/
+#include <mariacpp/bits/decode.hpp>
+#include <mariacpp/bits/parse.hpp>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+#ifndef WIN32
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+// Cells decoded by given kernel must match scalar from_chars()
+static int check(const char* kernel, const std::vector<const char*>& cells, const std::vector<unsigned long>& lengths) {
+    const size_t count = cells.size();
+    std::vector<int64_t> int64s(count);
+    std::vector<uint64_t> uint64s(count);
+    MariaCpp::decode_int64(cells.data(), lengths.data(), 1, count, int64s.data());
+    MariaCpp::decode_uint64(cells.data(), lengths.data(), 1, count, uint64s.data());
+    for (size_t i = 0; i < count; ++i) {
+        const char* cell = cells[i];
+        const int64_t want_int64 = cell ? MariaCpp::from_chars<int64_t>(cell, cell + lengths[i]) : 0;
+        const uint64_t want_uint64 = cell ? MariaCpp::from_chars<uint64_t>(cell, cell + lengths[i]) : 0;
+        if (int64s[i] != want_int64 || uint64s[i] != want_uint64) {
+            std::cerr << kernel << ": cell '" << (cell ? std::string(cell, lengths[i]) : "NULL")
+                      << "' decoded as " << int64s[i] << "/" << uint64s[i]
+                      << ", expected " << want_int64 << "/" << want_uint64 << std::endl;
+            return 1;
+        }
+    }
+    // Every other cell (stride 2), as rows of two columns
+    if (2 <= count) {
+        std::vector<int64_t> strided(count / 2);
+        MariaCpp::decode_int64(cells.data(), lengths.data(), 2, count / 2, strided.data());
+        for (size_t i = 0; i < count / 2; ++i) {
+            if (strided[i] != int64s[2 * i]) {
+                std::cerr << kernel << ": strided cell " << 2 * i << " decoded as " << strided[i] << std::endl;
+                return 1;
+            }
+        }
+    }
+    return 0;
+}
+
+int test() {
+    std::vector<std::string> values = {
+            "", "-", "-0", "0", "+1", "7", "-7", "007", "12a3", "a1", " 1", "1 ", "12.5", "--1",
+            "1234567890123456", "-1234567890123456", "9999999999999999",
+            "12345678901234567", "-12345678901234567", "99999999999999999",
+            "9223372036854775807", "-9223372036854775808", "9223372036854775808",
+            "18446744073709551615", "18446744073709551616", "99999999999999999999",
+            "123456789012345/", "12345678901234:5"};
+    std::mt19937_64 random(42);
+    for (int i = 0; i < 10000; ++i) {
+        const int digits = 1 + static_cast<int>(random() % 20);
+        std::string value = random() % 2 ? "-" : "";
+        for (int d = 0; d < digits; ++d) value += static_cast<char>('0' + random() % 10);
+        if (random() % 16 == 0) value[random() % value.size()] = static_cast<char>(random() % 128);
+        values.push_back(value);
+    }
+
+    std::vector<const char*> cells;
+    std::vector<unsigned long> lengths;
+    for (const std::string& value: values) {
+        cells.push_back(value.c_str());
+        lengths.push_back(static_cast<unsigned long>(value.size()));
+        // NULL after each value, so that NULL is paired with digits too
+        cells.push_back(nullptr);
+        lengths.push_back(0);
+        cells.push_back(value.c_str());
+        lengths.push_back(static_cast<unsigned long>(value.size()));
+    }
+
+#ifndef WIN32
+    // Cells ending right before unreadable page: kernels must not load
+    // 16 bytes across page boundary
+    const long page = sysconf(_SC_PAGESIZE);
+    char* pages = static_cast<char*>(mmap(nullptr, 2 * page, PROT_READ | PROT_WRITE,
+                                          MAP_PRIVATE | MAP_ANONYMOUS, -1, 0));
+    if (MAP_FAILED == pages || mprotect(pages + page, page, PROT_NONE)) {
+        std::cerr << "mmap() failed" << std::endl;
+        return 1;
+    }
+    for (unsigned long length = 1; length <= 20; ++length) {
+        char* cell = pages + page - length;
+        for (unsigned long d = 0; d < length; ++d) cell[d] = static_cast<char>('1' + d % 9);
+        cells.push_back(cell);
+        lengths.push_back(length);
+    }
+#endif
+
+    const struct {
+        MariaCpp::decode_kernel kernel;
+        const char* name;
+    } kernels[] = {{MariaCpp::DECODE_SCALAR, "scalar"},
+                   {MariaCpp::DECODE_SSE42, "SSE4.2"},
+                   {MariaCpp::DECODE_AVX2, "AVX2"}};
+    int failed = 0;
+    for (const auto& k: kernels) {
+        MariaCpp::set_decode_kernel(k.kernel);
+        if (MariaCpp::decode_kernel_in_use() != k.kernel) {
+            std::clog << k.name << " kernel is not supported by CPU, skipped" << std::endl;
+            continue;
+        }
+        failed |= check(k.name, cells, lengths);
+    }
+
+#ifndef WIN32
+    munmap(pages, 2 * page);
+#endif
+    return failed;
+}
+
+int main() {
+    return test();
+}
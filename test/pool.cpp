@@ -0,0 +1,195 @@
+/****************************************************************************
+  Copyright (C) 2015 Karol Roslaniec <mariacpp@roslaniec.net>
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not see <http://www.gnu.org/licenses>
+  or write to the Free Software Foundation, Inc.,
+  51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+*****************************************************************************/
+#define _CRT_SECURE_NO_WARNINGS
+#include <mariacpp/lib.hpp>
+#include <mariacpp/connection.hpp>
+#include <mariacpp/connection_pool.hpp>
+#include <mariacpp/mariadb_error.hpp>
+#include <mariacpp/prepared_stmt.hpp>
+#include <mariacpp/resultset.hpp>
+#include <mariacpp/uri.hpp>
+#include <atomic>
+#include <cstdint>
+#include <cstdlib>
+#include <future>
+#include <iostream>
+#include <memory>
+#include <set>
+#include <vector>
+
+std::atomic<int> in_use = 0;
+std::atomic<int> max_in_use = 0;
+
+int thread_start(MariaCpp::ConnectionPool& pool, unsigned rounds) {
+    // It's very important to call thread_init() method
+    MariaCpp::scoped_thread_init maria_thread;
+
+    try {
+        for (unsigned i = 0; i < rounds; ++i) {
+            MariaCpp::ConnectionPool::Lease conn = pool.acquire();
+            int now = ++in_use;
+            int prev = max_in_use;
+            while (prev < now && !max_in_use.compare_exchange_weak(prev, now));
+
+            conn->query("SELECT CONNECTION_ID()");
+            std::unique_ptr<MariaCpp::ResultSet> res(conn->store_result());
+            if (!res || !res->next() || res->getUInt64(0) != conn->thread_id()) {
+                std::cerr << "Unexpected connection id" << std::endl;
+                return 1;
+            }
+            --in_use;
+        } // Lease goes back to the pool
+    } catch (MariaCpp::mariadb_error& e) {
+        std::cerr << e << std::endl;
+        return 1;
+    }
+    return 0;
+}
+
+int test(const char* uri, const char* user, const char* passwd) {
+    std::clog << "DB uri: " << uri << std::endl;
+    std::clog << "DB user: " << user << std::endl;
+    std::clog << "DB passwd: " << passwd << std::endl;
+
+    const unsigned pool_size = 3;
+    const unsigned num_threads = 8;
+    int err_count = 0;
+    try {
+        // Size is checked before anything is allocated
+        for (size_t bad_size : {size_t(0), size_t(UINT32_MAX)}) {
+            try {
+                MariaCpp::ConnectionPool bad(MariaCpp::Uri(uri), user, passwd, bad_size);
+                std::cerr << "Invalid pool size accepted" << std::endl;
+                ++err_count;
+            } catch (MariaCpp::InvalidArgumentException&) {
+            }
+        }
+
+        MariaCpp::ConnectionPool pool(MariaCpp::Uri(uri), user, passwd, pool_size);
+
+        // More threads than connections: acquire() has to wait for release
+        std::vector<std::future<int>> futures;
+        for (unsigned tnum = 0; tnum < num_threads; tnum++)
+            futures.emplace_back(std::async(std::launch::async, thread_start, std::ref(pool), 50u));
+        for (auto& fut : futures)
+            err_count += fut.get();
+
+        std::clog << "Max connections in use: " << max_in_use << std::endl;
+        if (pool_size < static_cast<unsigned>(max_in_use)) {
+            std::cerr << "Pool handed out too many connections" << std::endl;
+            ++err_count;
+        }
+
+        // All connections are free again
+        std::vector<MariaCpp::ConnectionPool::Lease> leases;
+        std::set<unsigned long> ids;
+        for (unsigned i = 0; i < pool_size; ++i) {
+            leases.push_back(pool.try_acquire());
+            if (leases.back()) ids.insert(leases.back()->thread_id());
+        }
+        if (ids.size() != pool_size || pool.try_acquire()) {
+            std::cerr << "Unexpected pool state" << std::endl;
+            ++err_count;
+        }
+        leases.clear();
+
+        // Dirty connection is reset on return, so session state is gone
+        MariaCpp::ConnectionPool single(MariaCpp::Uri(uri), user, passwd, 1);
+        unsigned long id;
+        {
+            MariaCpp::ConnectionPool::Lease conn = single.acquire();
+            conn->query("SET @pool_test = 1");
+            id = conn->thread_id();
+        }
+        {
+            MariaCpp::ConnectionPool::Lease conn = single.acquire();
+            if (conn->dirty() || conn->thread_id() != id) {
+                std::cerr << "Connection was not reset" << std::endl;
+                ++err_count;
+            }
+            conn->query("SELECT @pool_test IS NULL");
+            std::unique_ptr<MariaCpp::ResultSet> res(conn->store_result());
+            if (!res || !res->next() || res->getInt(0) != 1) {
+                std::cerr << "Session variable survived reset" << std::endl;
+                ++err_count;
+            }
+        }
+
+        // Connection used read-only is returned without reset
+        {
+            MariaCpp::ConnectionPool::Lease conn = single.acquire();
+            MariaCpp::Connection::ReadOnly ro(*conn);
+            conn->query("SELECT 1");
+            std::unique_ptr<MariaCpp::ResultSet> res(conn->store_result());
+            // Not read-only really: marker shows session wasn't reset
+            conn->query("SET @pool_marker = 1");
+            id = conn->thread_id();
+        }
+        {
+            MariaCpp::ConnectionPool::Lease conn = single.acquire();
+            if (conn->dirty() || conn->thread_id() != id) {
+                std::cerr << "Read-only connection is dirty" << std::endl;
+                ++err_count;
+            }
+            conn->query("SELECT @pool_marker = 1");
+            std::unique_ptr<MariaCpp::ResultSet> res(conn->store_result());
+            if (!res || !res->next() || res->getInt(0) != 1) {
+                std::cerr << "Read-only connection was reset" << std::endl;
+                ++err_count;
+            }
+        }
+
+        // Concurrent warm-up with pre-prepared statements
+        MariaCpp::ConnectionPool warm(MariaCpp::Uri(uri), user, passwd, 4);
+        warm.set_statements({"SELECT ? + 1"});
+        if (warm.warm_up() != warm.size()) {
+            std::cerr << "Warm-up failed" << std::endl;
+            ++err_count;
+        }
+        {
+            MariaCpp::ConnectionPool::Lease conn = warm.acquire();
+            MariaCpp::PreparedStatement& stmt = conn.statement(0);
+            stmt.setInt(0, 41);
+            stmt.execute();
+            if (!stmt.fetch() || stmt.getInt(0) != 42 || conn->dirty()) {
+                std::cerr << "Unexpected result of pool statement" << std::endl;
+                ++err_count;
+            }
+        }
+    } catch (MariaCpp::mariadb_error& e) {
+        std::cerr << e << std::endl;
+        return 1;
+    }
+    return err_count;
+}
+
+int main() {
+    // In multithreaded MariaDB environment you MUST call library_init()
+    // method from main thread before creating other threads!
+    MariaCpp::scoped_library_init maria_lib_init;
+
+    const char* uri = std::getenv("TEST_DB_URI");
+    const char* user = std::getenv("TEST_DB_USER");
+    const char* passwd = std::getenv("TEST_DB_PASSWD");
+    if (!uri) uri = "tcp://localhost:3306/test";
+    if (!user) user = "test";
+    if (!passwd) passwd = "";
+
+    return test(uri, user, passwd);
+}
@@ -18,6 +18,8 @@
 *****************************************************************************/
 #define _CRT_SECURE_NO_WARNINGS
 #include <mariacpp/lib.hpp>
+#include <mariacpp/arrow.hpp>
+#include <mariacpp/columnar_result.hpp>
 #include <mariacpp/connection.hpp>
 #include <mariacpp/mariadb_error.hpp>
 #include <mariacpp/prepared_stmt.hpp>
@@ -27,6 +29,28 @@
 #include <cstdlib>
 #include <iostream>
 #include <memory>
+#include <optional>
+#include <string_view>
+#include <vector>
+
+#ifdef MARIADB_VERSION_ID
+struct Item {
+    int32_t id;
+    char label[8];
+    unsigned long label_len;
+    char label_ind;
+    MYSQL_TIME d;
+};
+
+template<>
+struct MariaCpp::row_mapping<Item> {
+    static constexpr auto fields() {
+        return std::make_tuple(MariaCpp::field(&Item::id),
+                               MariaCpp::field(&Item::label, &Item::label_len, &Item::label_ind),
+                               MariaCpp::field(&Item::d).as(MYSQL_TYPE_DATE));
+    }
+};
+#endif
 
 int test(const char* uri, const char* user, const char* passwd) {
     std::clog << "DB uri: " << uri << std::endl;
@@ -66,6 +90,77 @@ int test(const char* uri, const char* user, const char* passwd) {
         stmt->setTime(2, MariaCpp::Time("2016-01-22"));
         stmt->execute();
 
+#       ifdef MARIADB_VERSION_ID
+        // Bulk insert: column-wise arrays, single round trip
+        const int32_t ids[] = {5, 6, 7};
+        const char* labels[] = {"e", "f 123", nullptr};
+        const unsigned long lengths[] = {1, 5, 0};
+        const char indicators[] = {STMT_INDICATOR_NONE, STMT_INDICATOR_NONE, STMT_INDICATOR_NULL};
+        const MYSQL_TIME dates[] = {MariaCpp::Time("2020-01-01"), MariaCpp::Time("2020-01-02"),
+                                    MariaCpp::Time("2020-01-03")};
+        const MYSQL_TIME* date_ptrs[] = {&dates[0], &dates[1], &dates[2]};
+        stmt->setArray(0, ids);
+        try {
+            stmt->setArray(1, labels, nullptr, indicators);
+            std::cerr << "String array without lengths accepted" << std::endl;
+            return 1;
+        } catch (MariaCpp::InvalidArgumentException&) {
+        }
+        stmt->setArray(1, labels, lengths, indicators);
+        stmt->setArray(2, date_ptrs, MYSQL_TYPE_DATE);
+        stmt->executeBatch(3);
+        if (stmt->affected_rows() != 3) {
+            std::cerr << "Unexpected number of rows inserted in batch" << std::endl;
+            return 1;
+        }
+        {
+            std::unique_ptr<MariaCpp::PreparedStatement> check(
+                    conn.prepare("SELECT id, label, d FROM test WHERE id BETWEEN 5 AND 7 ORDER BY id"));
+            check->execute();
+            for (int i = 0; i < 3; ++i) {
+                if (!check->fetch() || check->getInt(0) != ids[i]
+                    || (labels[i] ? check->getString(1) != labels[i] : !check->isNull(1))
+                    || check->getTime(2).year != dates[i].year || check->getTime(2).day != dates[i].day) {
+                    std::cerr << "Unexpected row inserted in batch" << std::endl;
+                    return 1;
+                }
+            }
+            if (check->fetch()) return 1;
+        }
+
+        // Row-wise bulk insert straight from structs
+        std::vector<Item> items = {
+                {9, "i", 1, STMT_INDICATOR_NONE, MariaCpp::Time("2021-01-01")},
+                {10, "", 0, STMT_INDICATOR_NULL, MariaCpp::Time("2021-01-02")},
+        };
+        stmt->executeRows(std::span<const Item>(items));
+        if (stmt->affected_rows() != items.size()) {
+            std::cerr << "Unexpected number of rows inserted from structs" << std::endl;
+            return 1;
+        }
+        items[0].id = 11;
+        stmt->executeRows(std::span(items).first(1), MariaCpp::field(&Item::id),
+                          MariaCpp::field(&Item::label, &Item::label_len),
+                          MariaCpp::field(&Item::d).as(MYSQL_TYPE_DATE));
+        {
+            std::unique_ptr<MariaCpp::PreparedStatement> check(
+                    conn.prepare("SELECT id, label FROM test WHERE id BETWEEN 9 AND 11 ORDER BY id"));
+            check->execute();
+            if (!check->fetch() || check->getInt(0) != 9 || check->getString(1) != "i"
+                || !check->fetch() || check->getInt(0) != 10 || !check->isNull(1)
+                || !check->fetch() || check->getInt(0) != 11 || check->getString(1) != "i" || check->fetch()) {
+                std::cerr << "Unexpected row inserted from structs" << std::endl;
+                return 1;
+            }
+        }
+
+        // Back to single row
+        stmt->setInt(0, 8);
+        stmt->setString(1, "h");
+        stmt->setNull(2);
+        stmt->execute();
+#       endif
+
 
         // Select results using C-style result binding
         std::clog << "Selecting from DB:" << std::endl;
@@ -81,6 +176,135 @@ int test(const char* uri, const char* user, const char* passwd) {
             std::cout << std::endl;
         }
 
+        // Results fetched straight into struct members
+        struct Label {
+            int32_t id;
+            char label[8];
+            unsigned long label_len;
+            char label_null;
+        } row;
+        stmt.reset(conn.prepare("SELECT id, label FROM test WHERE id <= 2 ORDER BY id"));
+        stmt->execute();
+        stmt->bindResult(row, MariaCpp::field(&Label::id),
+                         MariaCpp::field(&Label::label, &Label::label_len, &Label::label_null));
+        if (!stmt->fetch() || row.id != 1 || row.label_null || std::string(row.label, row.label_len) != "a"
+            || !stmt->fetch() || row.id != 2 || !stmt->truncated() || row.label_len != 22 || stmt->fetch()) {
+            std::cerr << "Unexpected row fetched into struct" << std::endl;
+            return 1;
+        }
+
+        // Rows decoded to tuples, column types checked once
+        stmt.reset(conn.prepare("SELECT id, label, d FROM test WHERE id <= 3 ORDER BY id"));
+        stmt->execute();
+        int64_t count = 0;
+        for (auto [id, label, d]: stmt->rows<int64_t, std::string_view, std::optional<MariaCpp::Time>>()) {
+            if (id != ++count || label[0] != 'a' + id - 1 || d.has_value() != (3 == id)) {
+                std::cerr << "Unexpected row " << id << std::endl;
+                return 1;
+            }
+        }
+        if (count != 3) {
+            std::cerr << "Unexpected number of rows" << std::endl;
+            return 1;
+        }
+
+        // Zero-copy views of string and DECIMAL columns, NULL gives empty view
+        stmt.reset(conn.prepare("SELECT label, CAST(id + 0.5 AS DECIMAL(5,2)) FROM test WHERE id IN (1, 4) ORDER BY id"));
+        stmt->execute();
+        if (!stmt->fetch() || stmt->getStringView(0) != "a" || stmt->getStringView(1) != "1.50"
+            || stmt->getBytes(1).size() != 4 || static_cast<char>(stmt->getBytes(0)[0]) != 'a'
+            || !stmt->fetch() || !stmt->isNull(0) || !stmt->getStringView(0).empty() || !stmt->getBytes(0).empty()
+            || stmt->getStringView(1) != "4.50" || stmt->fetch()) {
+            std::cerr << "Unexpected string view" << std::endl;
+            return 1;
+        }
+
+        // Statement result decoded into columns, the rest exported to Arrow
+        stmt.reset(conn.prepare("SELECT id, label FROM test WHERE id <= 4 ORDER BY id"));
+        stmt->execute();
+        {
+            MariaCpp::ColumnarResult columnar(*stmt, 2);
+            if (columnar.rows() != 2 || columnar.column("id").int64s[1] != 2
+                || columnar.column(1).getStringView(0) != "a") {
+                std::cerr << "Unexpected columnar result" << std::endl;
+                return 1;
+            }
+            ArrowSchema schema;
+            ArrowArray batch;
+            MariaCpp::export_arrow(*stmt, &schema, &batch);
+            const int64_t* ids = static_cast<const int64_t*>(batch.children[0]->buffers[1]);
+            const bool ok = batch.length == 2 && std::string_view(schema.children[0]->format) == "l"
+                            && std::string_view(schema.children[1]->format) == "U"
+                            && ids[0] == 3 && ids[1] == 4 && batch.children[1]->null_count == 1;
+            batch.release(&batch);
+            schema.release(&schema);
+            if (!ok) {
+                std::cerr << "Unexpected Arrow batch" << std::endl;
+                return 1;
+            }
+        }
+
+#       ifdef MARIADB_VERSION_ID
+        // Prepare and execute in single round trip
+        stmt.reset(conn.execute_direct("SELECT COUNT(*) FROM test WHERE id > ? AND label <> ?",
+                                       2, std::string("x")));
+        if (!stmt->fetch() || stmt->getInt(0) != 6) {
+            std::cerr << "Unexpected result of execute_direct()" << std::endl;
+            return 1;
+        }
+#       endif
+
+        // Cached statements are prepared once per SQL
+        conn.set_statement_cache(2);
+        MariaCpp::PreparedStatement* cached;
+        {
+            MariaCpp::StatementCache::Lease lease = conn.prepare_cached("SELECT label FROM test WHERE id = ?");
+            cached = lease.get();
+            lease->setInt(0, 1);
+            lease->execute();
+            if (!lease->fetch() || lease->getString(0) != "a") {
+                std::cerr << "Unexpected result of cached statement" << std::endl;
+                return 1;
+            }
+            // Same SQL while leased: private statement
+            MariaCpp::StatementCache::Lease other = conn.prepare_cached("SELECT label FROM test WHERE id = ?");
+            if (other.get() == cached) {
+                std::cerr << "Statement leased twice" << std::endl;
+                return 1;
+            }
+        } // unread rows are freed on return
+        {
+            MariaCpp::StatementCache::Lease lease = conn.prepare_cached("SELECT label FROM test WHERE id = ?");
+            if (lease.get() != cached) {
+                std::cerr << "Statement was not cached" << std::endl;
+                return 1;
+            }
+            lease->setInt(0, 2);
+            lease->execute();
+            if (!lease->fetch() || lease->getString(0) != "b 12345678901234567890") {
+                std::cerr << "Unexpected result of reused statement" << std::endl;
+                return 1;
+            }
+        }
+        {
+            MariaCpp::StatementCache::Lease lease = conn.prepare_cached("SELECT label FROM test WHERE id = ?");
+            // Params of previous lease were reset on return
+            try {
+                lease->execute();
+                std::cerr << "Params of previous lease reused" << std::endl;
+                return 1;
+            } catch (MariaCpp::InvalidArgumentException&) {
+            }
+            // Cache disabled while leased, statement is closed on return
+            conn.set_statement_cache(0);
+            lease->setInt(0, 1);
+            lease->execute();
+            if (!lease->fetch() || lease->getString(0) != "a") {
+                std::cerr << "Unexpected result of statement leased over set_statement_cache()" << std::endl;
+                return 1;
+            }
+        }
+
         conn.query("DROP TEMPORARY TABLE IF EXISTS test");
 
         // conn.close(); // optional
@@ -18,13 +18,21 @@
 *****************************************************************************/
 #define _CRT_SECURE_NO_WARNINGS
 #include <mariacpp/lib.hpp>
+#include <mariacpp/arrow.hpp>
+#include <mariacpp/bounded_result.hpp>
+#include <mariacpp/columnar_result.hpp>
+#include <mariacpp/columns.hpp>
 #include <mariacpp/connection.hpp>
 #include <mariacpp/mariadb_error.hpp>
+#include <mariacpp/prefetch_result.hpp>
 #include <mariacpp/resultset.hpp>
+#include <mariacpp/time.hpp>
 #include <mariacpp/uri.hpp>
 #include <cstdlib>
 #include <iostream>
 #include <memory>
+#include <optional>
+#include <ranges>
 
 int test(const char* uri, const char* user, const char* passwd) {
     std::clog << "DB uri: " << uri << std::endl;
@@ -58,6 +66,181 @@ int test(const char* uri, const char* user, const char* passwd) {
         }
         res.reset();
 
+        // Column name is looked up once (case-insensitive), not on every row
+        conn.query("SELECT id, label FROM test WHERE id = 3");
+        res.reset(conn.store_result());
+        const MariaCpp::ColumnRef label = res->column("LABEL");
+        if (label != 1 || !res->next() || res->getInt("ID") != 3 || res->getStringView(label) != "c") return 1;
+        res.reset();
+
+        // Zero-copy views of row data, NULL gives empty view
+        conn.query("SELECT label, CAST(id + 0.5 AS DECIMAL(5,2)), d FROM test WHERE id = 1");
+        res.reset(conn.store_result());
+        if (!res->next() || res->getStringView(0) != "a" || res->getStringView(1) != "1.50"
+            || res->getBytes(1).size() != 4 || static_cast<char>(res->getBytes(0)[0]) != 'a'
+            || !res->isNull(2) || !res->getStringView(2).empty() || !res->getBytes(2).empty())
+            return 1;
+        res.reset();
+
+        // Names of fixed query are resolved once per result
+        conn.query("SELECT label, id FROM test WHERE id = 2");
+        res.reset(conn.store_result());
+        MariaCpp::Columns<"id", "label"> cols(*res);
+        if (!res->next() || res->getInt(cols.get<"id">()) != 2 || res->getStringView(cols.get<"label">()) != "b")
+            return 1;
+        MariaCpp::Columns<"id", "label"> copy(cols);
+        if (copy.get<"label">() != cols.get<"label">()) return 1;
+        res.reset();
+
+        // Result is input range of rows, composable with views
+        conn.query("SELECT id, label FROM test ORDER BY id");
+        res.reset(conn.store_result());
+        int sum = 0;
+        for (int id: *res | std::views::filter([](const MariaCpp::ResultSet& row) { return row.getStringView(1) != "b"; })
+                          | std::views::transform([](const MariaCpp::ResultSet& row) { return row.getInt(0); }))
+            sum += id;
+        if (sum != 4) return 1;
+        res.reset();
+
+        // Rows decoded to tuples, temporal text parsed to Time
+        conn.query("SELECT id, d FROM test ORDER BY id");
+        res.reset(conn.store_result());
+        int64_t count = 0;
+        for (auto [id, d]: res->rows<int64_t, std::optional<MariaCpp::Time>>()) {
+            if (id != ++count || d.has_value() != (1 != id)
+                || (d && (d->time_type != MYSQL_TIMESTAMP_DATETIME || d->year < 2019))) {
+                std::cerr << "Unexpected row " << id << std::endl;
+                return 1;
+            }
+        }
+        if (count != 3) return 1;
+        res.reset();
+
+        // Whole result decoded into per-column arrays
+        conn.query("SELECT id, label, d FROM test ORDER BY id");
+        res.reset(conn.store_result());
+        MariaCpp::ColumnarResult columnar(*res);
+        const MariaCpp::ColumnarResult::Column& ids = columnar.column("id");
+        const MariaCpp::ColumnarResult::Column& dates = columnar.column(2);
+        if (columnar.rows() != 3 || ids.type != MariaCpp::ColumnarResult::COLUMN_INT64 || ids.int64s[2] != 3
+            || columnar.column("label").getStringView(1) != "b" || !dates.isNull(0) || dates.null_count != 1)
+            return 1;
+        res.reset();
+
+        // Result exported to Arrow in batches, released by consumer
+        conn.query("SELECT id, label, d FROM test ORDER BY id");
+        res.reset(conn.use_result());
+        ArrowSchema schema;
+        ArrowArray batch;
+        int64_t exported = 0;
+        for (;;) {
+            MariaCpp::export_arrow(*res, &schema, &batch, 2);
+            const int64_t length = batch.length;
+            if (length && (schema.n_children != 3 || std::string_view(schema.children[0]->format) != "l"
+                           || std::string_view(schema.children[1]->format) != "U"
+                           || std::string_view(schema.children[2]->format) != "U"))
+                return 1;
+            if (!exported) {
+                // ids 1, 2; labels "a", "b"; d NULL in first row
+                const int64_t* ids = static_cast<const int64_t*>(batch.children[0]->buffers[1]);
+                const int64_t* offsets = static_cast<const int64_t*>(batch.children[1]->buffers[1]);
+                const char* labels = static_cast<const char*>(batch.children[1]->buffers[2]);
+                if (length != 2 || ids[0] != 1 || ids[1] != 2 || offsets[2] != 2
+                    || std::string_view(labels, 2) != "ab" || batch.children[2]->null_count != 1)
+                    return 1;
+            }
+            exported += length;
+            batch.release(&batch);
+            schema.release(&schema);
+            if (!length) break;
+        }
+        if (exported != 3) return 1;
+        res.reset();
+
+        // Streamed rows read ahead by background thread
+        conn.query("SELECT id, label FROM test ORDER BY id");
+        res.reset(conn.use_result());
+        {
+            MariaCpp::PrefetchResult prefetched(*res, 2, 2);
+            int64_t ids = 0;
+            for (const MariaCpp::PrefetchResult& row: prefetched)
+                if (row.getStringView(row.column("label")) != "b") ids += row.getInt64(0);
+            if (ids != 4) return 1;
+        }
+        res.reset();
+
+        // Stopped early while reader waits for free slot of full ring,
+        // unread rows are discarded by res.reset()
+        conn.query("SELECT a.id FROM test a, test b, test c");
+        res.reset(conn.use_result());
+        {
+            MariaCpp::PrefetchResult prefetched(*res, 1, 2);
+            if (!prefetched.next() || !prefetched.getInt(0)) return 1;
+        }
+        res.reset();
+        conn.query("SELECT COUNT(*) FROM test");
+        res.reset(conn.store_result());
+        if (!res->next() || res->getInt(0) != 3) return 1;
+        res.reset();
+
+        // Error of reader thread is thrown by next() after rows read before it
+        // (subquery returns more than 1 row for id 3 only)
+        conn.query("SELECT id, IF(id < 3, id, (SELECT id FROM test)) FROM test");
+        res.reset(conn.use_result());
+        {
+            MariaCpp::PrefetchResult prefetched(*res, 1, 2);
+            int rows = 0;
+            try {
+                while (prefetched.next()) ++rows;
+                return 1;
+            } catch (MariaCpp::mariadb_error& e) {
+                std::clog << "Expected error: " << e << std::endl;
+            }
+            if (2 < rows || prefetched.next()) return 1;
+        }
+        res.reset();
+
+        // Rows over memory budget are spilled to temporary file
+        conn.query("SELECT id, label FROM test ORDER BY id");
+        res.reset(conn.use_result());
+        {
+            MariaCpp::BoundedResult bounded(*res, 8);
+            if (bounded.num_rows() != 3 || !bounded.spilled()) return 1;
+            bounded.data_seek(2);
+            if (!bounded.next() || bounded.getInt(0) != 3 || bounded.next()) return 1;
+            bounded.data_seek(1);
+            if (!bounded.next() || bounded.getStringView(bounded.column("label")) != "b") return 1;
+        }
+        res.reset();
+
+        // Errors are classified, stack traces are captured only on request
+        try {
+            conn.query("SELEC 1");
+            return 1;
+        } catch (MariaCpp::syntax_error& e) {
+            if (!e.get_stacktrace().empty()) return 1;
+        }
+        MariaCpp::mariadb_error::capture_stacktrace<MariaCpp::syntax_error>();
+        try {
+            conn.query("SELECT * FROM test_missing");
+            return 1;
+        } catch (MariaCpp::syntax_error& e) {
+            std::clog << "Expected error: " << e << std::endl << e.get_stacktrace() << std::endl;
+        }
+        MariaCpp::mariadb_error::capture_stacktrace(MariaCpp::ERROR_ALL, false);
+
+        // Non-throwing API returns errors as values
+        conn.query("CREATE TEMPORARY TABLE test_unique (id INT PRIMARY KEY)");
+        if (!conn.try_query("INSERT INTO test_unique VALUES (1)")) return 1;
+        auto dup = conn.try_query("INSERT INTO test_unique VALUES (1)");
+        if (dup || dup.error().category() != MariaCpp::ERROR_INTEGRITY) return 1;
+        std::clog << "Expected error: " << dup.error() << std::endl;
+        if (!conn.try_query("SELECT id FROM test_unique")) return 1;
+        res.reset(conn.store_result());
+        auto row = res->try_next();
+        if (!row || !*row || res->getInt(0) != 1) return 1;
+        res.reset();
+
         conn.query("DROP TEMPORARY TABLE IF EXISTS test");
 
         // conn.close(); // optional
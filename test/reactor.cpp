@@ -0,0 +1,143 @@
+/****************************************************************************
+  Copyright (C) 2015 Karol Roslaniec <mariacpp@roslaniec.net>
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not see <http://www.gnu.org/licenses>
+  or write to the Free Software Foundation, Inc.,
+  51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+*****************************************************************************/
+#define _CRT_SECURE_NO_WARNINGS
+#include <mariacpp/lib.hpp>
+#include <mariacpp/connection.hpp>
+#include <mariacpp/mariadb_error.hpp>
+#include <mariacpp/reactor.hpp>
+#include <mariacpp/resultset.hpp>
+#include <mariacpp/uri.hpp>
+#include <chrono>
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <memory>
+#include <vector>
+
+#ifdef MARIADB_VERSION_ID
+// One connection driven by the reactor: connect, query, fetch one row
+struct Client {
+    MariaCpp::Connection conn;
+    std::unique_ptr<MariaCpp::ResultSet> res;
+    bool row = false;
+    int value = -1;
+    int errors = 0;
+
+    void failed(std::exception_ptr error) {
+        ++errors;
+        try {
+            std::rethrow_exception(error);
+        } catch (MariaCpp::mariadb_error& e) {
+            std::cerr << e << std::endl;
+        }
+    }
+
+    void start(MariaCpp::Reactor& reactor, const MariaCpp::Uri& uri,
+               const char* user, const char* passwd, int id) {
+        conn.options(MYSQL_OPT_NONBLOCK, nullptr);
+        conn.connect_start(uri, user, passwd);
+        reactor.submit(conn, [this](int status) { conn.connect_cont(status); },
+                       [this, &reactor, id](std::exception_ptr error) {
+            if (error) return failed(error);
+            query(reactor, id);
+        });
+    }
+
+    void query(MariaCpp::Reactor& reactor, int id) {
+        conn.query_start("SELECT SLEEP(0.2), " + std::to_string(id));
+        reactor.submit(conn, [this](int status) { conn.query_cont(status); },
+                       [this, &reactor](std::exception_ptr error) {
+            if (error) return failed(error);
+            res.reset(conn.store_result_start());
+            reactor.submit(conn, [this](int status) { res.reset(conn.store_result_cont(status)); },
+                           [this, &reactor](std::exception_ptr error) {
+                if (error) return failed(error);
+                fetch(reactor);
+            });
+        });
+    }
+
+    // Fetches rows until end of result set
+    void fetch(MariaCpp::Reactor& reactor) {
+        row = res->next_start();
+        reactor.submit(*res, [this](int status) { row = res->next_cont(status); },
+                       [this, &reactor](std::exception_ptr error) {
+            if (error) return failed(error);
+            if (!row) return res.reset();
+            value = res->getInt(1);
+            fetch(reactor);
+        });
+    }
+};
+#endif
+
+int test(const char* uri, const char* user, const char* passwd) {
+    std::clog << "DB uri: " << uri << std::endl;
+    std::clog << "DB user: " << user << std::endl;
+    std::clog << "DB passwd: " << passwd << std::endl;
+
+    int err_count = 0;
+#   ifdef MARIADB_VERSION_ID
+    try {
+        const int num_clients = 16;
+        MariaCpp::Reactor reactor;
+        std::vector<std::unique_ptr<Client>> clients;
+        const auto started = std::chrono::steady_clock::now();
+        for (int i = 0; i < num_clients; ++i) {
+            clients.emplace_back(new Client);
+            clients.back()->start(reactor, MariaCpp::Uri(uri), user, passwd, i);
+        }
+        reactor.run();
+        const auto elapsed = std::chrono::steady_clock::now() - started;
+        std::clog << "All queries finished in "
+                  << std::chrono::duration_cast<std::chrono::milliseconds>(elapsed).count()
+                  << " ms" << std::endl;
+
+        for (int i = 0; i < num_clients; ++i) {
+            err_count += clients[i]->errors;
+            if (clients[i]->value != i) {
+                std::cerr << "Unexpected result of client " << i << std::endl;
+                ++err_count;
+            }
+        }
+        // Queries were in flight concurrently, not one after another
+        if (std::chrono::seconds(2) < elapsed) {
+            std::cerr << "Queries were not multiplexed" << std::endl;
+            ++err_count;
+        }
+    } catch (MariaCpp::mariadb_error& e) {
+        std::cerr << e << std::endl;
+        return 1;
+    }
+#   endif
+    return err_count;
+}
+
+int main() {
+    MariaCpp::scoped_library_init maria_lib_init;
+
+    const char* uri = std::getenv("TEST_DB_URI");
+    const char* user = std::getenv("TEST_DB_USER");
+    const char* passwd = std::getenv("TEST_DB_PASSWD");
+    if (!uri) uri = "tcp://localhost:3306/test";
+    if (!user) user = "test";
+    if (!passwd) passwd = "";
+
+    return test(uri, user, passwd);
+}
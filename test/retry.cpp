@@ -0,0 +1,102 @@
+/****************************************************************************
+  Copyright (C) 2015 Karol Roslaniec <mariacpp@roslaniec.net>
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not see <http://www.gnu.org/licenses>
+  or write to the Free Software Foundation, Inc.,
+  51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+*****************************************************************************/
+#define _CRT_SECURE_NO_WARNINGS
+#include <mariacpp/lib.hpp>
+#include <mariacpp/connection.hpp>
+#include <mariacpp/mariadb_error.hpp>
+#include <mariacpp/resultset.hpp>
+#include <mariacpp/retry_policy.hpp>
+#include <mariacpp/uri.hpp>
+#include <mysqld_error.h>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+
+int test(const char* uri, const char* user, const char* passwd) {
+    std::clog << "DB uri: " << uri << std::endl;
+    std::clog << "DB user: " << user << std::endl;
+    std::clog << "DB passwd: " << passwd << std::endl;
+
+    int err_count = 0;
+    try {
+        MariaCpp::Connection owner, waiter;
+        owner.connect(MariaCpp::Uri(uri), user, passwd);
+        waiter.connect(MariaCpp::Uri(uri), user, passwd);
+
+        owner.query("CREATE TABLE IF NOT EXISTS retry_test (id INT PRIMARY KEY) ENGINE=InnoDB");
+        owner.query("REPLACE INTO retry_test VALUES (1)");
+
+        // Row stays locked by owner, so waiter hits ER_LOCK_WAIT_TIMEOUT
+        owner.autocommit(false);
+        owner.query("SELECT id FROM retry_test WHERE id = 1 FOR UPDATE");
+        delete owner.store_result();
+        waiter.query("SET SESSION innodb_lock_wait_timeout = 1");
+
+        unsigned callbacks = 0;
+        MariaCpp::RetryPolicy policy;
+        policy.max_attempts(3)
+              .backoff(std::chrono::milliseconds(1), std::chrono::milliseconds(10))
+              .on_retry([&callbacks](unsigned attempt, unsigned err_no, MariaCpp::RetryPolicy::duration) {
+                  std::clog << "Retry after attempt " << attempt << ", error " << err_no << std::endl;
+                  ++callbacks;
+              });
+        waiter.set_retry_policy(policy);
+        try {
+            waiter.query("UPDATE retry_test SET id = 2 WHERE id = 1");
+            std::cerr << "Update of locked row succeeded" << std::endl;
+            ++err_count;
+        } catch (MariaCpp::mariadb_error& e) {
+            if (e.errorno() != ER_LOCK_WAIT_TIMEOUT) throw;
+        }
+        if (callbacks != 2 || policy.retries() != 2 || policy.exhausted() != 1) {
+            std::cerr << "Unexpected retry counters" << std::endl;
+            ++err_count;
+        }
+        owner.rollback();
+
+        // Not retryable error is thrown immediately
+        try {
+            waiter.query("SELECT * FROM retry_test_missing");
+        } catch (MariaCpp::mariadb_error&) {
+        }
+        if (policy.retries() != 2) {
+            std::cerr << "Non-retryable error was retried" << std::endl;
+            ++err_count;
+        }
+
+        owner.query("DROP TABLE retry_test");
+    } catch (MariaCpp::mariadb_error& e) {
+        std::cerr << e << std::endl;
+        return 1;
+    }
+    return err_count;
+}
+
+int main() {
+    MariaCpp::scoped_library_init maria_lib_init;
+
+    const char* uri = std::getenv("TEST_DB_URI");
+    const char* user = std::getenv("TEST_DB_USER");
+    const char* passwd = std::getenv("TEST_DB_PASSWD");
+    if (!uri) uri = "tcp://localhost:3306/test";
+    if (!user) user = "test";
+    if (!passwd) passwd = "";
+
+    return test(uri, user, passwd);
+}